@@ -0,0 +1,7 @@
+// 主机测试用的最小桩头文件
+#ifndef DRIVER_GPIO_H
+#define DRIVER_GPIO_H
+
+typedef int gpio_num_t;
+
+#endif // DRIVER_GPIO_H
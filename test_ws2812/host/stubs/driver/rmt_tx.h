@@ -0,0 +1,5 @@
+// 主机测试用的最小桩头文件
+#ifndef DRIVER_RMT_TX_H
+#define DRIVER_RMT_TX_H
+
+#endif // DRIVER_RMT_TX_H
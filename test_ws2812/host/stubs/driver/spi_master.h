@@ -0,0 +1,10 @@
+// 主机测试用的最小桩头文件
+#ifndef DRIVER_SPI_MASTER_H
+#define DRIVER_SPI_MASTER_H
+
+typedef enum {
+    SPI1_HOST = 0,
+    SPI2_HOST = 1,
+} spi_host_device_t;
+
+#endif // DRIVER_SPI_MASTER_H
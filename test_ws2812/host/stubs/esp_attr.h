@@ -0,0 +1,8 @@
+// 主机测试用的最小桩头文件：放入IRAM/DRAM的属性在主机上没有意义
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#endif // ESP_ATTR_H
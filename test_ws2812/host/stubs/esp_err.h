@@ -0,0 +1,13 @@
+// 主机测试用的最小桩头文件：只提供被测模块用到的类型和错误码
+#ifndef ESP_ERR_H
+#define ESP_ERR_H
+
+#include <stdlib.h>     // 与ESP-IDF的esp_err.h一样间接提供size_t等
+
+typedef int esp_err_t;
+
+#define ESP_OK                  0
+#define ESP_FAIL                -1
+#define ESP_ERR_INVALID_ARG     0x102
+
+#endif // ESP_ERR_H
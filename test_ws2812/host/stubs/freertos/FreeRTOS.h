@@ -0,0 +1,24 @@
+// 主机测试用的最小桩头文件：portMUX临界区用C11自旋锁代替，可以在多个pthread之间互斥
+// 等待时让出CPU，持有者在临界区内被抢占时（单核机器）不会空转整个时间片
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdatomic.h>
+#include <sched.h>
+
+typedef struct {
+    atomic_flag flag;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    {ATOMIC_FLAG_INIT}
+
+#define portENTER_CRITICAL(mux) \
+    do { \
+        while (atomic_flag_test_and_set_explicit(&(mux)->flag, memory_order_acquire)) { \
+            sched_yield(); \
+        } \
+    } while (0)
+
+#define portEXIT_CRITICAL(mux)  atomic_flag_clear_explicit(&(mux)->flag, memory_order_release)
+
+#endif // FREERTOS_H
@@ -0,0 +1,7 @@
+// 主机测试用的最小桩头文件：只提供接收配置中用到的句柄类型
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+typedef void *SemaphoreHandle_t;
+
+#endif // SEMAPHORE_H
@@ -0,0 +1,160 @@
+// ws2812b_color的主机单元测试：定点颜色运算与双精度浮点参考实现比较误差
+// 只用到整数运算和标准C，在开发机上用gcc编译运行（见Makefile），不需要烧录
+#include <stdio.h>
+#include <stdbool.h>
+#include "ws2812b_color.h"
+
+// HSV/HSL转换允许的最大误差（8位级数）：段内位置只取8位，全范围扫描时两种转换都会出现2级误差
+#define MAX_HSV_ERROR   2
+#define MAX_HSL_ERROR   2
+
+static int s_failures = 0;
+
+static void check(bool ok, const char *name, int value, int limit)
+{
+    printf("%-32s %6d（上限 %d）%s\n", name, value, limit, ok ? "" : "  <-- 失败");
+    if (!ok) {
+        s_failures++;
+    }
+}
+
+// 浮点参考实现：HSV转RGB，h/s/v取0-1
+static void hsv_reference(double h, double s, double v, double rgb[3])
+{
+    double h6 = h * 6.0;
+    int sector = (int)h6;
+    double f = h6 - sector;
+    double p = v * (1.0 - s);
+    double q = v * (1.0 - s * f);
+    double t = v * (1.0 - s * (1.0 - f));
+    
+    switch (sector % 6) {
+    case 0:  rgb[0] = v; rgb[1] = t; rgb[2] = p; break;
+    case 1:  rgb[0] = q; rgb[1] = v; rgb[2] = p; break;
+    case 2:  rgb[0] = p; rgb[1] = v; rgb[2] = t; break;
+    case 3:  rgb[0] = p; rgb[1] = q; rgb[2] = v; break;
+    case 4:  rgb[0] = t; rgb[1] = p; rgb[2] = v; break;
+    default: rgb[0] = v; rgb[1] = p; rgb[2] = q; break;
+    }
+}
+
+// 定点结果与浮点参考（0-1）的最大误差（单位：8位级数）
+static int color_error(ws2812b_color_t color, const double rgb[3])
+{
+    const int channel[3] = {color.red, color.green, color.blue};
+    int max_error = 0;
+    
+    for (int i = 0; i < 3; i++) {
+        int expected = (int)(rgb[i] * 255.0 + 0.5);
+        int error = channel[i] > expected ? channel[i] - expected : expected - channel[i];
+        if (error > max_error) {
+            max_error = error;
+        }
+    }
+    return max_error;
+}
+
+// ws2812b_div255：0到255×255全部精确（四舍五入）
+static void test_div255(void)
+{
+    int wrong = 0;
+    
+    for (uint32_t x = 0; x <= 255 * 255; x++) {
+        if (ws2812b_div255(x) != (2 * x + 255) / 510) {
+            wrong++;
+        }
+    }
+    check(wrong == 0, "div255 错误个数（0-65025）", wrong, 0);
+}
+
+// lerp8和scale8：全部输入组合，结果与四舍五入的精确值一致
+static void test_lerp_scale(void)
+{
+    int lerp_wrong = 0;
+    int scale_wrong = 0;
+    
+    for (uint32_t a = 0; a < 256; a++) {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t exact = (2 * a * b + 255) / 510;
+            if (ws2812b_scale8(a, b) != exact) {
+                scale_wrong++;
+            }
+            for (uint32_t t = 0; t < 256; t++) {
+                uint32_t sum = a * (255 - t) + b * t;
+                if (ws2812b_lerp8(a, b, t) != (2 * sum + 255) / 510) {
+                    lerp_wrong++;
+                }
+            }
+        }
+    }
+    check(scale_wrong == 0, "scale8 错误个数", scale_wrong, 0);
+    check(lerp_wrong == 0, "lerp8 错误个数", lerp_wrong, 0);
+}
+
+// HSV和HSL：全部色相，饱和度和亮度每15级取一个（含0和255）
+static void test_hsv_hsl(void)
+{
+    int hsv_error = 0;
+    int hsl_error = 0;
+    
+    for (uint32_t hue = 0; hue < 65536; hue++) {
+        double h = hue / 65536.0;
+        for (uint32_t si = 0; si <= 255; si += 15) {
+            double s = si / 255.0;
+            for (uint32_t vi = 0; vi <= 255; vi += 15) {
+                double l = vi / 255.0;
+                double rgb[3];
+                int error;
+    
+                hsv_reference(h, s, l, rgb);
+                error = color_error(ws2812b_color_from_hsv(hue, si, vi), rgb);
+                if (error > hsv_error) {
+                    hsv_error = error;
+                }
+    
+                // HSL：v = l + s * min(l, 1 - l)，s_v = 2 * (1 - l / v)
+                double v = l + s * (l < 0.5 ? l : 1.0 - l);
+                hsv_reference(h, v > 0.0 ? 2.0 * (1.0 - l / v) : 0.0, v, rgb);
+                error = color_error(ws2812b_color_from_hsl(hue, si, vi), rgb);
+                if (error > hsl_error) {
+                    hsl_error = error;
+                }
+            }
+        }
+    }
+    check(hsv_error <= MAX_HSV_ERROR, "HSV 最大误差", hsv_error, MAX_HSV_ERROR);
+    check(hsl_error <= MAX_HSL_ERROR, "HSL 最大误差", hsl_error, MAX_HSL_ERROR);
+}
+
+// 饱和加法和降低饱和度的边界
+static void test_add_saturate(void)
+{
+    int wrong = 0;
+    
+    ws2812b_color_t sum = ws2812b_color_add((ws2812b_color_t){200, 100, 0, 255}, (ws2812b_color_t){100, 100, 0, 1});
+    if (sum.red != 255 || sum.green != 200 || sum.blue != 0 || sum.white != 255) {
+        wrong++;
+    }
+    
+    ws2812b_color_t color = {255, 0, 0, 7};
+    ws2812b_color_t same = ws2812b_color_saturate(color, 255);
+    ws2812b_color_t gray = ws2812b_color_saturate(color, 0);
+    if (same.red != 255 || same.green != 0 || same.blue != 0 || same.white != 7) {
+        wrong++;
+    }
+    if (gray.red != gray.green || gray.green != gray.blue || gray.white != 7) {
+        wrong++;
+    }
+    check(wrong == 0, "add/saturate 错误个数", wrong, 0);
+}
+
+int main(void)
+{
+    test_div255();
+    test_lerp_scale();
+    test_hsv_hsl();
+    test_add_saturate();
+    
+    printf("颜色运算测试%s\n", s_failures == 0 ? "通过" : "失败");
+    return s_failures == 0 ? 0 : 1;
+}
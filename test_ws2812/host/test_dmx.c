@@ -0,0 +1,160 @@
+// ws2812b_dmx_parse的主机单元测试：E1.31/Art-Net解析、格式错误、序号循环和宇宙范围
+// 数据包格式部分只用到标准C，在开发机上用gcc编译运行（见Makefile），不需要烧录
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "ws2812b_dmx.h"
+
+// 协议规定的字节位置，用来确认构造函数和解析按标准布局读写，而不只是彼此一致
+#define E131_SEQUENCE_BYTE      111
+#define E131_OPTIONS_BYTE       112
+#define E131_UNIVERSE_BYTE      113
+#define E131_START_CODE_BYTE    125
+#define E131_DATA_BYTE          126
+#define ARTNET_UNIVERSE_BYTE    14
+#define ARTNET_DATA_BYTE        18
+
+static int s_failures = 0;
+static uint8_t s_packet[WS2812B_DMX_MAX_PACKET_SIZE];
+static uint8_t s_channels[WS2812B_DMX_CHANNELS];
+
+static void check(bool ok, const char *name)
+{
+    printf("%-40s %s\n", name, ok ? "通过" : "<-- 失败");
+    if (!ok) {
+        s_failures++;
+    }
+}
+
+// E1.31：字段、数据指针、预览和流结束标志
+static void test_parse_e131(void)
+{
+    ws2812b_dmx_packet_t parsed;
+    size_t len = ws2812b_dmx_build_e131(s_packet, 300, 42, s_channels, 510);
+    
+    bool ok = ws2812b_dmx_parse(s_packet, len, &parsed) == ESP_OK;
+    check(ok && parsed.protocol == WS2812B_DMX_PROTO_E131 && parsed.universe == 300 && parsed.sequence == 42 &&
+          parsed.length == 510 && parsed.data == s_packet + E131_DATA_BYTE && !parsed.preview && !parsed.terminated,
+          "E1.31 字段");
+    check(s_packet[E131_UNIVERSE_BYTE] == 300 >> 8 && s_packet[E131_UNIVERSE_BYTE + 1] == (300 & 0xFF) &&
+          s_packet[E131_SEQUENCE_BYTE] == 42 && len == E131_DATA_BYTE + 510, "E1.31 字节布局");
+    
+    s_packet[E131_OPTIONS_BYTE] = 0x80;
+    ok = ws2812b_dmx_parse(s_packet, len, &parsed) == ESP_OK && parsed.preview && !parsed.terminated;
+    s_packet[E131_OPTIONS_BYTE] = 0x40;
+    ok = ok && ws2812b_dmx_parse(s_packet, len, &parsed) == ESP_OK && !parsed.preview && parsed.terminated;
+    check(ok, "E1.31 预览/流结束标志");
+    
+    // 只带几个通道的短包是合法的
+    len = ws2812b_dmx_build_e131(s_packet, 1, 0, s_channels, 3);
+    check(ws2812b_dmx_parse(s_packet, len, &parsed) == ESP_OK && parsed.length == 3 && parsed.sequence == 0,
+          "E1.31 短包（3个通道）");
+}
+
+// Art-Net：端口地址小端，高字节最高位不属于Net
+static void test_parse_artnet(void)
+{
+    ws2812b_dmx_packet_t parsed;
+    size_t len = ws2812b_dmx_build_artnet(s_packet, 0x1234, 7, s_channels, 512);
+    
+    bool ok = ws2812b_dmx_parse(s_packet, len, &parsed) == ESP_OK;
+    check(ok && parsed.protocol == WS2812B_DMX_PROTO_ARTNET && parsed.universe == 0x1234 && parsed.sequence == 7 &&
+          parsed.length == 512 && parsed.data == s_packet + ARTNET_DATA_BYTE, "Art-Net 字段");
+    check(s_packet[ARTNET_UNIVERSE_BYTE] == 0x34 && s_packet[ARTNET_UNIVERSE_BYTE + 1] == 0x12, "Art-Net 字节布局");
+    
+    s_packet[ARTNET_UNIVERSE_BYTE + 1] |= 0x80;
+    check(ws2812b_dmx_parse(s_packet, len, &parsed) == ESP_OK && parsed.universe == 0x1234, "Art-Net 端口地址最高位");
+}
+
+// 截断到任意长度都要拒绝；起始码、包头标识、长度字段错误也要拒绝
+static void test_malformed(void)
+{
+    ws2812b_dmx_packet_t parsed;
+    int accepted = 0;
+    
+    size_t len = ws2812b_dmx_build_e131(s_packet, 1, 1, s_channels, 510);
+    for (size_t n = 0; n < len; n++) {
+        accepted += ws2812b_dmx_parse(s_packet, n, &parsed) == ESP_OK;
+    }
+    len = ws2812b_dmx_build_artnet(s_packet, 1, 1, s_channels, 510);
+    for (size_t n = 0; n < len; n++) {
+        accepted += ws2812b_dmx_parse(s_packet, n, &parsed) == ESP_OK;
+    }
+    check(accepted == 0, "截断的数据包全部拒绝");
+    
+    len = ws2812b_dmx_build_e131(s_packet, 1, 1, s_channels, 510);
+    s_packet[E131_START_CODE_BYTE] = 0xDD;
+    bool rejected = ws2812b_dmx_parse(s_packet, len, &parsed) != ESP_OK;
+    len = ws2812b_dmx_build_e131(s_packet, 1, 1, s_channels, 510);
+    s_packet[4] ^= 0xFF;    // ACN包标识
+    rejected = rejected && ws2812b_dmx_parse(s_packet, len, &parsed) != ESP_OK;
+    check(rejected, "E1.31 起始码/包标识错误");
+    
+    // Art-Net声明的长度超过512或超过实际数据
+    len = ws2812b_dmx_build_artnet(s_packet, 1, 1, s_channels, 512);
+    s_packet[16] = 0x02;
+    s_packet[17] = 0x01;
+    rejected = ws2812b_dmx_parse(s_packet, len + 1, &parsed) != ESP_OK;
+    len = ws2812b_dmx_build_artnet(s_packet, 1, 1, s_channels, 100);
+    s_packet[17] = 101;
+    rejected = rejected && ws2812b_dmx_parse(s_packet, len, &parsed) != ESP_OK;
+    len = ws2812b_dmx_build_artnet(s_packet, 1, 1, s_channels, 100);
+    s_packet[9] = 0x21;     // ArtPoll等其他操作码
+    rejected = rejected && ws2812b_dmx_parse(s_packet, len, &parsed) != ESP_OK;
+    check(rejected, "Art-Net 长度/操作码错误");
+    
+    check(ws2812b_dmx_parse(s_packet, len, NULL) != ESP_OK && ws2812b_dmx_parse(NULL, len, &parsed) != ESP_OK,
+          "空指针");
+}
+
+// 序号：E1.31按0-255循环，0是有效序号；Art-Net按1-255循环，0表示不使用序号
+static void test_sequence(void)
+{
+    ws2812b_dmx_packet_t parsed;
+    
+    size_t len = ws2812b_dmx_build_e131(s_packet, 1, 0, s_channels, 3);
+    check(ws2812b_dmx_parse(s_packet, len, &parsed) == ESP_OK && ws2812b_dmx_has_sequence(&parsed),
+          "E1.31 序号0有效");
+    check(ws2812b_dmx_sequence_diff(WS2812B_DMX_PROTO_E131, 0, 255) == 1 &&
+          ws2812b_dmx_sequence_diff(WS2812B_DMX_PROTO_E131, 1, 0) == 1 &&
+          ws2812b_dmx_sequence_diff(WS2812B_DMX_PROTO_E131, 3, 250) == 9, "E1.31 255->0循环");
+    check(ws2812b_dmx_sequence_diff(WS2812B_DMX_PROTO_E131, 9, 9) == 0 &&
+          ws2812b_dmx_sequence_diff(WS2812B_DMX_PROTO_E131, 255, 0) == -1 &&
+          ws2812b_dmx_sequence_diff(WS2812B_DMX_PROTO_E131, 240, 4) == -20, "E1.31 重复/落后");
+    
+    len = ws2812b_dmx_build_artnet(s_packet, 1, 0, s_channels, 3);
+    bool ok = ws2812b_dmx_parse(s_packet, len, &parsed) == ESP_OK && !ws2812b_dmx_has_sequence(&parsed);
+    len = ws2812b_dmx_build_artnet(s_packet, 1, 1, s_channels, 3);
+    ok = ok && ws2812b_dmx_parse(s_packet, len, &parsed) == ESP_OK && ws2812b_dmx_has_sequence(&parsed);
+    check(ok, "Art-Net 序号0表示不使用");
+    check(ws2812b_dmx_sequence_diff(WS2812B_DMX_PROTO_ARTNET, 1, 255) == 1 &&
+          ws2812b_dmx_sequence_diff(WS2812B_DMX_PROTO_ARTNET, 2, 254) == 3 &&
+          ws2812b_dmx_sequence_diff(WS2812B_DMX_PROTO_ARTNET, 6, 3) == 3, "Art-Net 255->1循环（跳过0）");
+    check(ws2812b_dmx_sequence_diff(WS2812B_DMX_PROTO_ARTNET, 255, 1) == -1 &&
+          ws2812b_dmx_sequence_diff(WS2812B_DMX_PROTO_ARTNET, 5, 6) == -1, "Art-Net 落后");
+}
+
+// 宇宙范围：start_universe起连续universe_count个
+static void test_universe(void)
+{
+    check(ws2812b_dmx_universe_index(1, 1, 3) == 0 && ws2812b_dmx_universe_index(3, 1, 3) == 2, "宇宙在范围内");
+    check(ws2812b_dmx_universe_index(0, 1, 3) == -1 && ws2812b_dmx_universe_index(4, 1, 3) == -1 &&
+          ws2812b_dmx_universe_index(65535, 65535, 1) == 0 && ws2812b_dmx_universe_index(0, 65535, 1) == -1,
+          "不属于本灯带的宇宙");
+}
+
+int main(void)
+{
+    for (int i = 0; i < WS2812B_DMX_CHANNELS; i++) {
+        s_channels[i] = (uint8_t)(i * 7);
+    }
+    
+    test_parse_e131();
+    test_parse_artnet();
+    test_malformed();
+    test_sequence();
+    test_universe();
+    
+    printf("DMX解析测试%s\n", s_failures == 0 ? "通过" : "失败");
+    return s_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+// wifi_seqlock的主机压力测试：两个写入线程和两个读取线程用pthreads并发运行，
+// 读者检查每个快照内各字段都属于同一次写入；portMUX由stubs/freertos/FreeRTOS.h中的自旋锁代替
+// 写入和复制都在中途定期让出CPU，单核机器上也会频繁交错（去掉序号检查时能读到不一致的快照）
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "wifi_seqlock.h"
+
+#define WRITERS         2
+#define READERS         2
+#define WRITES          1000000     // 每个写入线程的写入次数
+
+// 受保护的记录：与wifi_info_t和连接耗时一样由多个字段组成，每个字段都由写入序号n决定
+typedef struct {
+    uint32_t n;
+    int state;
+    char ssid[32];
+    int8_t rssi;
+    uint8_t channel;
+    uint32_t total_ms;
+} record_t;
+
+static wifi_seqlock_t s_seqlock = WIFI_SEQLOCK_INIT;
+static record_t s_record;
+static atomic_int s_writers;
+
+typedef struct {
+    uint32_t reads;
+    uint32_t retries;
+    uint32_t torn;
+    uint32_t last_n;                // 读到的最大序号，检查读者能看到写入者的进度
+} reader_result_t;
+
+static void fill(record_t *r, uint32_t n)
+{
+    r->n = n;
+    r->state = (int)(n % 5);
+    memset(r->ssid, 'A' + n % 26, sizeof(r->ssid) - 1);
+    r->ssid[sizeof(r->ssid) - 1] = '\0';
+    r->rssi = -(int8_t)(n % 100);
+    r->channel = n % 13 + 1;
+    r->total_ms = n * 7;
+}
+
+static bool consistent(const record_t *r)
+{
+    record_t expected;
+    fill(&expected, r->n);
+    return memcmp(r, &expected, sizeof(expected)) == 0;
+}
+
+// 写入线程：arg为起始序号，两个写入线程的序号不重叠
+static void *writer(void *arg)
+{
+    uint32_t first = (uint32_t)(uintptr_t)arg;
+    
+    for (uint32_t i = 0; i < WRITES; i++) {
+        wifi_seqlock_write_begin(&s_seqlock);
+        fill(&s_record, first + i);
+        if ((i & 63) == 0) {
+            s_record.n = first + i;     // 写到一半让出CPU：序号为奇数，读者应跳过
+            sched_yield();
+        }
+        wifi_seqlock_write_end(&s_seqlock);
+        if ((i & 15) == 8) {
+            sched_yield();              // 写完让出CPU，读者在两次写入之间读取
+        }
+    }
+    atomic_fetch_sub(&s_writers, 1);
+    return NULL;
+}
+
+// 读取线程：与wifi_info_read()相同的读取循环，写入线程全部结束前一直读取并检查
+static void *reader(void *arg)
+{
+    reader_result_t *result = arg;
+    record_t copy;
+    uint32_t attempts = 0;
+    
+    while (atomic_load(&s_writers) > 0) {
+        while (1) {
+            unsigned seq = wifi_seqlock_read_begin(&s_seqlock);
+            if (!(seq & 1)) {
+                // 复制到一半时定期让出CPU，让写入者有机会在复制期间修改记录
+                memcpy(&copy, &s_record, sizeof(copy) / 2);
+                if ((++attempts & 63) == 0) {
+                    sched_yield();
+                }
+                memcpy((uint8_t *)&copy + sizeof(copy) / 2, (uint8_t *)&s_record + sizeof(copy) / 2,
+                       sizeof(copy) - sizeof(copy) / 2);
+                if (!wifi_seqlock_read_retry(&s_seqlock, seq)) {
+                    break;
+                }
+            }
+            result->retries++;
+            sched_yield();              // 单核机器上自旋会占满时间片，让写入者先完成
+        }
+        result->reads++;
+        if (!consistent(&copy)) {
+            result->torn++;
+        }
+        if (copy.n > result->last_n) {
+            result->last_n = copy.n;
+        }
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t writers[WRITERS], readers[READERS];
+    reader_result_t results[READERS] = {0};
+    bool ok = true;
+    
+    fill(&s_record, 0);
+    atomic_store(&s_writers, WRITERS);
+    for (int i = 0; i < READERS; i++) {
+        ok = ok && pthread_create(&readers[i], NULL, reader, &results[i]) == 0;
+    }
+    for (int i = 0; i < WRITERS; i++) {
+        ok = ok && pthread_create(&writers[i], NULL, writer, (void *)(uintptr_t)(1 + i * WRITES)) == 0;
+    }
+    if (!ok) {
+        printf("创建线程失败\n");
+        return 1;
+    }
+    for (int i = 0; i < WRITERS; i++) {
+        pthread_join(writers[i], NULL);
+    }
+    for (int i = 0; i < READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    
+    uint32_t reads = 0, retries = 0, torn = 0, progressed = 0;
+    for (int i = 0; i < READERS; i++) {
+        reads += results[i].reads;
+        retries += results[i].retries;
+        torn += results[i].torn;
+        progressed += results[i].last_n > 0;
+    }
+    printf("写入 %u 次，读取 %u 次（因并发写入重读 %u 次），不一致 %u 次\n",
+           (unsigned)(WRITERS * WRITES), (unsigned)reads, (unsigned)retries, (unsigned)torn);
+    
+    // 全部写入完成后序号为偶数，记录是最后一次写入之一
+    bool final_ok = (atomic_load(&s_seqlock.seq) == 2u * WRITERS * WRITES) && consistent(&s_record);
+    bool passed = torn == 0 && reads > 0 && progressed == READERS && final_ok;
+    printf("状态快照压力测试%s\n", passed ? "通过" : "失败");
+    return passed ? 0 : 1;
+}
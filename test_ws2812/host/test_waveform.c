@@ -0,0 +1,160 @@
+// 后端波形的主机单元测试：同一帧分别按RMT与SPI后端的编码方式展开，逐位比较逻辑值与高电平时间
+// SPI位展开和RMT位时序都是纯C（ws2812b_encode.c），在开发机上用gcc编译运行（见Makefile），不需要烧录
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "ws2812b_backend.h"
+
+#define TOLERANCE_NS    150     // WS2812B数据手册允许的高电平误差
+
+static int s_failures = 0;
+
+static void check(bool ok, const char *name)
+{
+    printf("%-40s %s\n", name, ok ? "通过" : "<-- 失败");
+    if (!ok) {
+        s_failures++;
+    }
+}
+
+// SPI位流中第bit位的电平（MSB先发）
+static int spi_level(const uint8_t *stream, size_t bit)
+{
+    return (stream[bit / 8] >> (7 - bit % 8)) & 1;
+}
+
+// 每个字节值单独展开：8个WS2812B位依次为100或110，紧凑模式（无查找表）逐字节展开
+static void test_expand_all_bytes(void)
+{
+    uint8_t stream[WS2812B_SPI_BYTES_PER_BYTE + WS2812B_SPI_RESET_BYTES];
+    int wrong = 0;
+    
+    for (int value = 0; value < 256; value++) {
+        uint8_t byte = (uint8_t)value;
+        ws2812b_spi_encode_frame(&byte, 1, NULL, 1, NULL, stream);
+        for (int i = 0; i < 8; i++) {
+            int bit = (value >> (7 - i)) & 1;
+            size_t base = (size_t)i * WS2812B_SPI_BITS_PER_BIT;
+            if (spi_level(stream, base) != 1 || spi_level(stream, base + 1) != bit || spi_level(stream, base + 2) != 0) {
+                wrong++;
+            }
+        }
+    }
+    check(wrong == 0, "SPI 256个字节值的位展开");
+}
+
+// 一种芯片、一种颜色顺序：查表路径与RMT逐位比较，检查复位码，紧凑模式位流与查表路径相同
+static bool compare_backends(const ws2812b_chip_t *chip, int order, const uint8_t *frame, uint16_t led_count,
+                             const uint8_t *lut, uint8_t *spi_stream, uint8_t *packed_stream)
+{
+    const uint8_t bpp = chip->bytes_per_pixel;
+    const size_t frame_size = (size_t)led_count * bpp;
+    const size_t spi_size = ws2812b_spi_frame_size(led_count, bpp);
+    uint8_t packed[64];
+    
+    ws2812b_spi_encode_frame(frame, frame_size, ws2812b_order_map[order], bpp, lut, spi_stream);
+    
+    size_t spi_bit = 0;
+    for (uint16_t p = 0; p < led_count; p++) {
+        for (int channel = 0; channel < bpp; channel++) {
+            // RMT后端按同一映射取字节并查表，MSB先发
+            uint8_t wire_byte = lut[frame[p * bpp + ws2812b_order_map[order][channel]]];
+            packed[p * bpp + channel] = wire_byte;
+            
+            for (int i = 7; i >= 0; i--) {
+                int bit = (wire_byte >> i) & 1;
+                uint32_t rmt_high_ns, rmt_low_ns;
+                ws2812b_rmt_bit_timing(chip, bit, &rmt_high_ns, &rmt_low_ns);
+                
+                // SPI位流中一个WS2812B位占3个SPI位，高电平时间 = 前导1的个数 × SPI位时间
+                uint32_t ones = 0;
+                for (int k = 0; k < WS2812B_SPI_BITS_PER_BIT; k++, spi_bit++) {
+                    if (spi_level(spi_stream, spi_bit) && ones == (uint32_t)k) {
+                        ones++;
+                    }
+                }
+                uint32_t spi_high_ns = ones * WS2812B_SPI_BIT_NS;
+                int spi_logic = spi_high_ns > (uint32_t)(chip->t0h_ns + chip->t1h_ns) / 2;
+                uint32_t diff = spi_high_ns > rmt_high_ns ? spi_high_ns - rmt_high_ns : rmt_high_ns - spi_high_ns;
+                
+                if (spi_logic != bit || diff > TOLERANCE_NS) {
+                    printf("波形不一致: %s 顺序%d 像素%d 通道%d 位%d, RMT高电平%uns, SPI高电平%uns\n",
+                           chip->name, order, p, channel, i, (unsigned)rmt_high_ns, (unsigned)spi_high_ns);
+                    return false;
+                }
+            }
+        }
+    }
+    
+    // 帧尾复位码必须全为低电平，且时长不短于芯片要求的复位时间
+    size_t reset_bytes = spi_size - spi_bit / 8;
+    for (size_t i = spi_bit / 8; i < spi_size; i++) {
+        if (spi_stream[i] != 0) {
+            printf("SPI复位码不为低电平: %s\n", chip->name);
+            return false;
+        }
+    }
+    if (reset_bytes * 8 * WS2812B_SPI_BIT_NS < (uint32_t)chip->reset_us * 1000) {
+        printf("SPI复位码过短: %s %uns\n", chip->name, (unsigned)(reset_bytes * 8 * WS2812B_SPI_BIT_NS));
+        return false;
+    }
+    
+    // 紧凑模式：预先按线上顺序查表打包的帧直接发送，位流必须与查表路径完全相同
+    ws2812b_spi_encode_frame(packed, frame_size, NULL, bpp, NULL, packed_stream);
+    if (memcmp(packed_stream, spi_stream, spi_size) != 0) {
+        printf("紧凑模式位流不一致: %s 顺序%d\n", chip->name, order);
+        return false;
+    }
+    return true;
+}
+
+// 覆盖SPI后端支持时序的芯片（WS2812B、WS2815）和RGBW（4字节）像素格式，全部颜色顺序
+static void test_backend_waveform(void)
+{
+    // 覆盖全0、全1、交替位和各通道不同值，按像素格式取前3或4个字节
+    static const uint8_t pattern[][4] = {
+        {0x00, 0xFF, 0x55, 0x0F}, {0xAA, 0x01, 0x80, 0xF0}, {0x12, 0x34, 0x56, 0x78}, {0xFF, 0x00, 0x7E, 0x81},
+    };
+    const uint16_t led_count = sizeof(pattern) / sizeof(pattern[0]);
+    static uint8_t spi_stream[4 * 4 * WS2812B_SPI_BYTES_PER_BYTE + WS2812B_SPI_RESET_BYTES];
+    static uint8_t packed_stream[sizeof(spi_stream)];
+    
+    // RGBW格式使用WS2812B时序，只检查4字节像素的布局
+    ws2812b_chip_t rgbw_chip = ws2812b_chip_ws2812b;
+    rgbw_chip.name = "WS2812B（4字节像素）";
+    rgbw_chip.bytes_per_pixel = 4;
+    const ws2812b_chip_t *chips[] = {&ws2812b_chip_ws2812b, &ws2812b_chip_ws2815, &rgbw_chip};
+    
+    // 恒等查找表和非恒等查找表（半亮度+伽马），两种后端的查表路径都检查
+    uint8_t luts[2][256];
+    ws2812b_build_lut(luts[0], 255, false);
+    ws2812b_build_lut(luts[1], 128, true);
+    
+    for (size_t c = 0; c < sizeof(chips) / sizeof(chips[0]); c++) {
+        const ws2812b_chip_t *chip = chips[c];
+        uint8_t frame[sizeof(pattern)];
+        bool ok = true;
+        
+        for (uint16_t p = 0; p < led_count; p++) {
+            memcpy(frame + p * chip->bytes_per_pixel, pattern[p], chip->bytes_per_pixel);
+        }
+        for (int l = 0; l < 2 && ok; l++) {
+            for (int order = 0; order < WS2812B_ORDER_MAX && ok; order++) {
+                ok = compare_backends(chip, order, frame, led_count, luts[l], spi_stream, packed_stream);
+            }
+        }
+        
+        char name[64];
+        snprintf(name, sizeof(name), "RMT/SPI 波形一致: %s", chip->name);
+        check(ok, name);
+    }
+}
+
+int main(void)
+{
+    test_expand_all_bytes();
+    test_backend_waveform();
+    
+    printf("后端波形测试%s\n", s_failures == 0 ? "通过" : "失败");
+    return s_failures == 0 ? 0 : 1;
+}
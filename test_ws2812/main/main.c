@@ -3,40 +3,38 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "nvs_flash.h"
 #include "esp_netif.h"
 #include "esp_event.h"
 #include "ws2812b_driver.h"
+#include "ws2812b_effect.h"
+#include "ws2812b_dmx.h"
+#include "ws2812b_ddp.h"
+#include "ws2812b_http.h"
 #include "wifi_manager.h"
 #include "wifi_config.h"
 #include "ws2812b_config.h"
 
 static const char *TAG = "MAIN";
 
-// 任务句柄
-static TaskHandle_t wifi_monitor_task_handle = NULL;
-
-// WiFi状态回调函数
-static void wifi_state_callback(wifi_state_t state, void *user_data)
+// WiFi状态订阅者：打印状态变化
+static void wifi_log_subscriber(const wifi_manager_event_t *event, void *ctx)
 {
-    switch (state) {
+    switch (event->state) {
         case WIFI_STATE_DISCONNECTED:
             ESP_LOGI(TAG, "WiFi状态: 未连接");
-            // 可以在这里添加LED指示，比如红色闪烁
             break;
         case WIFI_STATE_CONNECTING:
             ESP_LOGI(TAG, "WiFi状态: 连接中");
-            // 可以在这里添加LED指示，比如黄色常亮
             break;
         case WIFI_STATE_CONNECTED:
             ESP_LOGI(TAG, "WiFi状态: 已连接");
-            // 可以在这里添加LED指示，比如绿色常亮
             break;
         case WIFI_STATE_FAILED:
-            ESP_LOGE(TAG, "WiFi状态: 连接失败");
-            // 可以在这里添加LED指示，比如红色常亮
+            ESP_LOGE(TAG, "WiFi状态: 连接失败（后台继续重试）");
             break;
         case WIFI_STATE_DISCONNECTING:
             ESP_LOGI(TAG, "WiFi状态: 断开连接中");
@@ -44,33 +42,122 @@ static void wifi_state_callback(wifi_state_t state, void *user_data)
     }
 }
 
-// WiFi IP回调函数
-static void wifi_ip_callback(const char *ip_addr, void *user_data)
+// LED状态指示：未联网时灯带以呼吸方式显示状态（连接中为琥珀色，连接失败为红色），获取IP后恢复原来的效果
+#define WIFI_STATUS_EFFECT      "wifi_status"
+#define WIFI_STATUS_PERIOD_MS   2000    // 呼吸周期
+#define WIFI_STATUS_LEVEL       64      // 最高亮度
+
+static volatile wifi_state_t s_led_state = WIFI_STATE_DISCONNECTED;
+static const char *s_led_saved_effect = NULL;  // 显示状态前的效果，只在WiFi通知中访问（通知依次发生）
+static bool s_led_showing = false;
+
+static void wifi_status_render(ws2812b_strip_t *strip, const ws2812b_effect_frame_t *frame, void *user_ctx)
 {
-    ESP_LOGI(TAG, "获取到IP地址: %s", ip_addr);
+    uint32_t phase = (frame->elapsed_us / 1000) % WIFI_STATUS_PERIOD_MS;
+    uint32_t half = WIFI_STATUS_PERIOD_MS / 2;
+    uint8_t level = (phase < half ? phase : WIFI_STATUS_PERIOD_MS - phase) * WIFI_STATUS_LEVEL / half;
     
-    // 可以在这里添加网络相关的功能
-    // 比如启动HTTP服务器、MQTT客户端等
+    if (s_led_state == WIFI_STATE_FAILED) {
+        ws2812b_strip_set_all_pixels(strip, (ws2812b_color_t){level, 0, 0, 0});
+    } else {
+        ws2812b_strip_set_all_pixels(strip, (ws2812b_color_t){level, level / 2, 0, 0});
+    }
 }
 
-// WiFi监控任务
-static void wifi_monitor_task(void *pvParameters)
+static void led_status_subscriber(const wifi_manager_event_t *event, void *ctx)
 {
-    ESP_LOGI(TAG, "WiFi监控任务启动");
-    
-    while (1) {
-        wifi_info_t wifi_info;
-        if (wifi_manager_get_info(&wifi_info) == ESP_OK) {
-            // 每10秒打印一次WiFi状态
-            if (wifi_info.state == WIFI_STATE_CONNECTED) {
-                ESP_LOGI(TAG, "WiFi状态: 已连接 | SSID: %s | RSSI: %d | IP: %s", 
-                         wifi_info.ssid, wifi_info.rssi, wifi_manager_get_ip_string());
-            } else {
-                ESP_LOGI(TAG, "WiFi状态: %d", wifi_info.state);
+    if (event->event == WIFI_MANAGER_EVENT_GOT_IP) {
+        // 已联网：状态效果仍在显示时恢复之前的效果
+        if (s_led_showing) {
+            s_led_showing = false;
+            const char *current = ws2812b_effect_get_current();
+            if (!current || strcmp(current, WIFI_STATUS_EFFECT) == 0) {
+                ws2812b_effect_select(s_led_saved_effect ? s_led_saved_effect : WS2812B_EFFECT_RAINBOW);
             }
         }
-        
-        vTaskDelay(pdMS_TO_TICKS(10000));
+        return;
+    }
+    
+    // 关联完成到获取IP之间和主动断开时保持当前画面
+    if (event->state == WIFI_STATE_CONNECTED || event->state == WIFI_STATE_DISCONNECTING) {
+        return;
+    }
+    
+    s_led_state = event->state;
+    if (!s_led_showing) {
+        s_led_saved_effect = ws2812b_effect_get_current();
+        s_led_showing = true;
+        ws2812b_effect_select(WIFI_STATUS_EFFECT);
+    }
+}
+
+// 正在发送数据的网络数据源数（DMX、DDP），两个接收任务都会修改
+static int s_active_sources = 0;
+static SemaphoreHandle_t s_source_mutex = NULL;
+static StaticSemaphore_t s_source_mutex_buf;
+
+// DMX和DDP接收任务共用灯带：写入像素和提交显示互斥，两个数据源同时发送时不会同时改写后台缓冲区
+static SemaphoreHandle_t s_strip_mutex = NULL;
+static StaticSemaphore_t s_strip_mutex_buf;
+
+// 灯光控制台开始/停止发送数据：第一个数据源接管灯带时停止本地效果，全部停止后恢复
+// 计数和启停效果引擎在同一把锁内完成，一个数据源停止、另一个同时开始时不会在数据流上重新启动本地效果
+static void network_source_callback(bool active, void *user_data)
+{
+    xSemaphoreTake(s_source_mutex, portMAX_DELAY);
+    s_active_sources += active ? 1 : -1;
+    if (active && s_active_sources == 1) {
+        ws2812b_effect_engine_stop();
+    } else if (!active && s_active_sources == 0) {
+        ws2812b_effect_engine_start(ws2812b_get_default_strip(), WS2812B_EFFECT_FPS);
+    }
+    xSemaphoreGive(s_source_mutex);
+}
+
+// 网络服务订阅者：获取IP后启动网络接收和控制接口，ctx为输出灯带
+static void network_service_subscriber(const wifi_manager_event_t *event, void *ctx)
+{
+    ws2812b_strip_t *strip = ctx;
+    
+    ESP_LOGI(TAG, "获取到IP地址: " IPSTR, IP2STR(&event->ip_addr));
+    
+    // WiFi状态只在变化时打印，不再定时轮询
+    wifi_info_t wifi_info;
+    if (wifi_manager_get_info(&wifi_info) == ESP_OK) {
+        ESP_LOGI(TAG, "WiFi: %s | 信号: %d dBm | 信道: %d", wifi_info.ssid, wifi_info.rssi, wifi_info.channel);
+    }
+    
+    // 启动E1.31 / Art-Net接收（重连后接收器仍在运行，不重复启动）
+    ws2812b_dmx_config_t dmx_config = {
+        .strip = strip,
+        .protocols = WS2812B_DMX_PROTO_E131 | WS2812B_DMX_PROTO_ARTNET,
+        .start_universe = WS2812B_DMX_START_UNIVERSE,
+        .on_source = network_source_callback,
+        .strip_lock = s_strip_mutex,
+    };
+    esp_err_t ret = ws2812b_dmx_start(&dmx_config);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "启动DMX接收失败: %s", esp_err_to_name(ret));
+    }
+    
+    // 启动DDP接收
+    ws2812b_ddp_config_t ddp_config = {
+        .strip = strip,
+        .on_source = network_source_callback,
+        .strip_lock = s_strip_mutex,
+    };
+    ret = ws2812b_ddp_start(&ddp_config);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "启动DDP接收失败: %s", esp_err_to_name(ret));
+    }
+    
+    // 启动HTTP控制接口
+    ws2812b_http_config_t http_config = {
+        .strip = strip,
+    };
+    ret = ws2812b_http_start(&http_config);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "启动HTTP接口失败: %s", esp_err_to_name(ret));
     }
 }
 
@@ -94,9 +181,12 @@ static esp_err_t init_wifi(void)
     // 初始化WiFi管理器
     ESP_ERROR_CHECK(wifi_manager_init());
     
-    // 设置回调函数
-    wifi_manager_set_event_callback(wifi_state_callback, NULL);
-    wifi_manager_set_ip_callback(wifi_ip_callback, NULL);
+    // 订阅连接状态：日志、LED状态指示、网络服务各自独立
+    ESP_ERROR_CHECK(wifi_manager_subscribe(WIFI_MANAGER_EVENT_STATE, wifi_log_subscriber, NULL, NULL));
+    ESP_ERROR_CHECK(wifi_manager_subscribe(WIFI_MANAGER_EVENT_STATE | WIFI_MANAGER_EVENT_GOT_IP,
+                                           led_status_subscriber, NULL, NULL));
+    ESP_ERROR_CHECK(wifi_manager_subscribe(WIFI_MANAGER_EVENT_GOT_IP, network_service_subscriber,
+                                           ws2812b_get_default_strip(), NULL));
     
     // 设置WiFi配置 - 直接连接，不通过配置结构体
     
@@ -120,10 +210,7 @@ void app_main(void)
     // 初始化NVS
     ESP_ERROR_CHECK(init_nvs());
     
-    // 初始化WiFi
-    ESP_ERROR_CHECK(init_wifi());
-    
-    // 初始化WS2812B驱动
+    // 初始化WS2812B驱动（WiFi状态指示需要先启动效果引擎）
     ESP_LOGI(TAG, "初始化WS2812B驱动，使用GPIO: %d", WS2812B_GPIO_PIN);
     esp_err_t ret = ws2812b_init(WS2812B_GPIO_PIN);
     if (ret != ESP_OK) {
@@ -133,20 +220,15 @@ void app_main(void)
     
     ESP_LOGI(TAG, "WS2812B驱动初始化成功！");
     
-    // 创建WiFi监控任务
-    BaseType_t wifi_task_created = xTaskCreate(
-        wifi_monitor_task,        // 任务函数
-        "wifi_monitor",           // 任务名称
-        4096,                     // 堆栈大小
-        NULL,                     // 任务参数
-        4,                        // 任务优先级
-        &wifi_monitor_task_handle // 任务句柄
-    );
-    
-    if (wifi_task_created != pdPASS) {
-        ESP_LOGE(TAG, "创建WiFi监控任务失败");
-        return;
-    }
+    // 启动效果引擎，在独立任务中渲染彩虹效果
+    ESP_ERROR_CHECK(ws2812b_effect_register(&(ws2812b_effect_t){WIFI_STATUS_EFFECT, wifi_status_render, NULL}));
+    ESP_ERROR_CHECK(ws2812b_effect_select(WS2812B_EFFECT_RAINBOW));
+    ESP_ERROR_CHECK(ws2812b_effect_engine_start(ws2812b_get_default_strip(), WS2812B_EFFECT_FPS));
+    
+    // 初始化WiFi（获取IP后启动网络接收，数据源回调需要的锁先创建好）
+    s_source_mutex = xSemaphoreCreateMutexStatic(&s_source_mutex_buf);
+    s_strip_mutex = xSemaphoreCreateMutexStatic(&s_strip_mutex_buf);
+    ESP_ERROR_CHECK(init_wifi());
     
     // 主任务可以在这里添加其他功能
     while (1) {
@@ -156,11 +238,51 @@ void app_main(void)
         // 每30秒打印一次系统状态
         ESP_LOGI(TAG, "系统运行中... 可用堆内存: %d bytes", esp_get_free_heap_size());
         
-        // 检查WiFi状态
-        if (wifi_manager_is_connected()) {
-            ESP_LOGI(TAG, "WiFi状态: 已连接 | IP: %s", wifi_manager_get_ip_string());
-        } else {
-            ESP_LOGW(TAG, "WiFi状态: 未连接");
+        // 效果引擎帧率与渲染耗时
+        ws2812b_effect_stats_t effect_stats;
+        if (ws2812b_effect_get_stats(&effect_stats) == ESP_OK) {
+            ESP_LOGI(TAG, "效果: %s | %lu/%lu fps | 渲染平均 %lu us, 最大 %lu us | 抖动平均 %lu us, 最大 %lu us | "
+                     "超时帧 %lu, 丢帧 %lu",
+                     ws2812b_effect_get_current() ? ws2812b_effect_get_current() : "无",
+                     (unsigned long)effect_stats.fps, (unsigned long)effect_stats.target_fps,
+                     (unsigned long)effect_stats.avg_render_us, (unsigned long)effect_stats.max_render_us,
+                     (unsigned long)effect_stats.avg_jitter_us, (unsigned long)effect_stats.max_jitter_us,
+                     (unsigned long)effect_stats.missed_deadlines, (unsigned long)effect_stats.dropped_frames);
+        }
+        
+        // 网络控制
+        ws2812b_dmx_stats_t dmx_stats;
+        if (ws2812b_dmx_get_stats(&dmx_stats) == ESP_OK && dmx_stats.packets > 0) {
+            ESP_LOGI(TAG, "DMX: %lu 包/秒 | 帧 %lu（未收齐 %lu）| 丢包 %lu, 乱序 %lu, 无效 %lu",
+                     (unsigned long)dmx_stats.packets_per_sec, (unsigned long)dmx_stats.frames,
+                     (unsigned long)dmx_stats.partial_frames, (unsigned long)dmx_stats.dropped_packets,
+                     (unsigned long)dmx_stats.late_packets, (unsigned long)dmx_stats.invalid_packets);
+        }
+        ws2812b_ddp_stats_t ddp_stats;
+        if (ws2812b_ddp_get_stats(&ddp_stats) == ESP_OK && ddp_stats.packets > 0) {
+            ESP_LOGI(TAG, "DDP: %lu 包/秒 | 帧 %lu | 丢包 %lu, 乱序 %lu, 迟到 %lu, 无效 %lu, 队列满 %lu | 处理平均 %lu us, 最大 %lu us",
+                     (unsigned long)ddp_stats.packets_per_sec, (unsigned long)ddp_stats.frames,
+                     (unsigned long)ddp_stats.dropped_packets, (unsigned long)ddp_stats.reordered_packets,
+                     (unsigned long)ddp_stats.late_packets,
+                     (unsigned long)ddp_stats.invalid_packets, (unsigned long)ddp_stats.queue_overflows,
+                     (unsigned long)ddp_stats.avg_decode_us, (unsigned long)ddp_stats.max_decode_us);
+        }
+        ws2812b_http_stats_t http_stats;
+        if (ws2812b_http_get_stats(&http_stats) == ESP_OK && http_stats.requests > 0) {
+            ESP_LOGI(TAG, "HTTP: 请求 %lu（错误 %lu）| 处理平均 %lu us, 最大 %lu us | 上传 %lu 帧（覆盖 %lu）, %lu B/s | "
+                     "交接平均 %lu us, 最大 %lu us",
+                     (unsigned long)http_stats.requests, (unsigned long)http_stats.errors,
+                     (unsigned long)http_stats.avg_latency_us, (unsigned long)http_stats.max_latency_us,
+                     (unsigned long)http_stats.frames, (unsigned long)http_stats.frames_overwritten,
+                     (unsigned long)http_stats.upload_bytes_per_sec, (unsigned long)http_stats.avg_handoff_us,
+                     (unsigned long)http_stats.max_handoff_us);
+        }
+        
+        // 内容未变化而跳过的刷新
+        ws2812b_strip_stats_t strip_stats;
+        if (ws2812b_strip_get_stats(ws2812b_get_default_strip(), &strip_stats) == ESP_OK) {
+            ESP_LOGI(TAG, "灯带: 已发送 %lu 帧 | 跳过 %lu 帧",
+                     (unsigned long)strip_stats.frames_done, (unsigned long)strip_stats.frames_skipped);
         }
     }
 }
\ No newline at end of file
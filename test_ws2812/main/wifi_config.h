@@ -10,9 +10,18 @@
 #define WIFI_PASSWORD           "E3A88888888@"    // 您的WiFi密码
 
 // 连接参数配置
-#define WIFI_MAX_RETRY          5                     // 最大重试次数
+#define WIFI_MAX_RETRY          5                     // 连续失败该次数后报告失败状态（后台继续重试）
 #define WIFI_TIMEOUT_MS         10000                 // 连接超时时间（毫秒）
 #define WIFI_RECONNECT_DELAY_MS 5000                  // 重连延迟时间（毫秒）
+#define WIFI_RECONNECT_MIN_MS   1000                  // 第一次重连前的等待（毫秒），之后每次失败翻倍
+#define WIFI_RECONNECT_MAX_MS   60000                 // 重连等待上限（毫秒）
+#define WIFI_RECONNECT_JITTER_PCT 20                  // 重连等待的随机抖动（±百分比）
+
+// 快速重连配置
+#define WIFI_FAST_CONNECT_ENABLE 1                    // 使用缓存的BSSID和信道定向连接：1=启用，0=禁用
+#define WIFI_FAST_STATIC_IP     1                     // 先使用缓存的IP、连上后再DHCP续租：1=启用，0=禁用
+#define WIFI_FAST_LEASE_TIMEOUT_MS 10000              // 续租超过该时间未确认时清除缓存（毫秒）
+#define WIFI_FAST_NVS_NAMESPACE "wifi_fast"           // 缓存所在的NVS命名空间
 
 // AP模式配置（可选）
 #define WIFI_AP_SSID            "ESP32-C3-AP"         // AP模式下的WiFi名称
@@ -32,13 +41,10 @@
 // 高级配置（一般不需要修改）
 // ============================================================================
 
-// 任务配置
-#define WIFI_TASK_STACK_SIZE    4096                  // WiFi任务堆栈大小
-#define WIFI_TASK_PRIORITY      5                     // WiFi任务优先级
-
 // 事件配置
+#define WIFI_SUBSCRIBER_MAX     8                     // 状态订阅者的最大数量（含兼容接口的两个回调）
 #define WIFI_EVENT_QUEUE_SIZE   32                    // 事件队列大小
-#define WIFI_EVENT_TIMEOUT_MS   1000                  // 事件超时时间
+#define WIFI_EVENT_TIMEOUT_MS   1000                  // 重新连接前等待断开事件的超时（毫秒）
 
 // 内存配置
 #define WIFI_MAX_SSID_LEN       32                    // 最大SSID长度
@@ -52,10 +58,26 @@
 #error "WIFI_MAX_RETRY 必须大于0"
 #endif
 
+#if WIFI_RECONNECT_MIN_MS <= 0 || WIFI_RECONNECT_MAX_MS < WIFI_RECONNECT_MIN_MS
+#error "WIFI_RECONNECT_MAX_MS 必须不小于 WIFI_RECONNECT_MIN_MS"
+#endif
+
+#if WIFI_RECONNECT_JITTER_PCT < 0 || WIFI_RECONNECT_JITTER_PCT >= 100
+#error "WIFI_RECONNECT_JITTER_PCT 必须在0-99范围内"
+#endif
+
+#if WIFI_FAST_LEASE_TIMEOUT_MS <= 0
+#error "WIFI_FAST_LEASE_TIMEOUT_MS 必须大于0"
+#endif
+
 #if WIFI_TIMEOUT_MS <= 0
 #error "WIFI_TIMEOUT_MS 必须大于0"
 #endif
 
+#if WIFI_SUBSCRIBER_MAX < 2
+#error "WIFI_SUBSCRIBER_MAX 必须至少为2（兼容接口占用两个）"
+#endif
+
 #if WIFI_AP_CHANNEL < 1 || WIFI_AP_CHANNEL > 13
 #error "WIFI_AP_CHANNEL 必须在1-13范围内"
 #endif
@@ -77,9 +99,13 @@
    - 请确保这些信息正确，否则无法连接
 
 2. 连接参数：
-   - WIFI_MAX_RETRY: 连接失败时的最大重试次数
+   - WIFI_MAX_RETRY: 连续失败该次数后状态变为WIFI_STATE_FAILED并触发回调，后台仍继续重试，连接成功后恢复
    - WIFI_TIMEOUT_MS: 连接超时时间，单位毫秒
    - WIFI_RECONNECT_DELAY_MS: 断开连接后的重连延迟
+   - WIFI_RECONNECT_MIN_MS / WIFI_RECONNECT_MAX_MS: 断开后由esp_timer安排重连，等待时间从MIN开始每次失败翻倍，
+     不超过MAX；WIFI_RECONNECT_JITTER_PCT为随机抖动，多个设备同时上电时错开重连
+   - 重连不在事件循环中等待，其他事件处理函数不受影响；wifi_manager_disconnect()后停止自动重连
+   - 快速重连缓存的NVS写入（保存、清除）也交给esp_timer任务执行，事件处理函数不写Flash
 
 3. AP模式配置：
    - 当ESP32-C3作为WiFi热点时的配置
@@ -93,6 +119,25 @@
    - WIFI_DEBUG_ENABLE: 是否启用调试输出
    - WIFI_LOG_LEVEL: 日志输出级别
 
+6. 快速重连：
+   - 每次通过DHCP获取IP后，把AP的BSSID、信道和IP租约（IP、网关、掩码、DNS）存入NVS
+   - 下次连接同一SSID时直接在缓存的信道上连接该BSSID，跳过全信道扫描
+   - WIFI_FAST_STATIC_IP启用时连接前先设置缓存的IP，关联完成即可收发数据；连上后立即重新启动DHCP客户端续租，
+     服务器确认后才写回缓存。IP已被分配给其他设备或路由器改了网段时服务器会拒绝，拿到的新租约覆盖缓存；
+     WIFI_FAST_LEASE_TIMEOUT_MS内没有拿到租约时清除缓存，下次按普通方式扫描并完整获取DHCP租约
+   - 重新启动DHCP客户端时esp_netif会清空接口地址，拿到租约前的短暂时间内收不到数据
+   - 定向连接失败时清除缓存、恢复DHCP并按普通方式扫描重连，不计入重试次数
+   - 也可调用wifi_manager_clear_cache()手动清除缓存，或把WIFI_FAST_STATIC_IP设为0只保留定向连接
+   - wifi_manager_get_timings()返回关联、获取IP各阶段的耗时
+
+7. 状态通知：
+   - WiFi管理器不创建任务：状态变化在默认事件循环中直接调用回调，重连由esp_timer触发
+   - 原来的wifi_task（每秒轮询事件位）和main.c中的wifi_monitor_task（每10秒打印状态）已删除，
+     节省两个4KB任务堆栈（连同任务控制块约8.7KB堆内存），空闲时不再有任何唤醒（原来约每秒1.1次）
+   - 需要知道连接状态的模块用wifi_manager_subscribe()订阅，不要轮询wifi_manager_get_state()
+   - 每个订阅者有自己的上下文和事件掩码（状态变化、获取IP、丢失IP），通知时不分配内存；
+     WIFI_SUBSCRIBER_MAX为订阅者上限，set_event_callback和set_ip_callback各占一个
+
 使用步骤：
 1. 修改WIFI_SSID和WIFI_PASSWORD为您的WiFi信息
 2. 根据需要调整其他参数
@@ -1,96 +1,549 @@
 #include "wifi_manager.h"
+#include "wifi_config.h"
+#include "wifi_seqlock.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 #include "esp_check.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_netif.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "nvs.h"
 #include "lwip/err.h"
 #include "lwip/sys.h"
 #include <string.h>
+#include <stdatomic.h>
 
 static const char *TAG = "WIFI_MANAGER";
 
-// 事件组位定义
-#define WIFI_CONNECTED_BIT    BIT0
-#define WIFI_FAIL_BIT         BIT1
-#define WIFI_GOT_IP_BIT       BIT2
-
 // 全局变量
-static EventGroupHandle_t s_wifi_event_group = NULL;
 static esp_netif_t *s_sta_netif = NULL;
 static esp_netif_t *s_ap_netif = NULL;
 static wifi_manager_config_t s_wifi_config = {0};
 static wifi_info_t s_wifi_info = {0};
-static wifi_event_callback_t s_event_callback = NULL;
-static wifi_ip_callback_t s_ip_callback = NULL;
-static void *s_user_data = NULL;
 static bool s_manager_initialized = false;
 static int s_retry_num = 0;
 
+// s_wifi_info和连接耗时的发布序号：写入者（事件循环、连接函数、重连定时器）之间互斥，
+// 读者无锁复制，不会阻塞事件循环，也不会读到一半新一半旧的记录
+static wifi_seqlock_t s_info_seqlock = WIFI_SEQLOCK_INIT;
+
+// 已删除的轮询任务（wifi_task每1秒、main.c中的wifi_monitor_task每10秒唤醒一次），初始化时据此报告节省的资源
+#define WIFI_REMOVED_TASKS             2
+#define WIFI_REMOVED_TASK_STACK        4096
+#define WIFI_REMOVED_WAKEUPS_PER_10S   11
+
+// 快速重连缓存：NVS中保存的上一次成功连接的AP和IP租约
+#define WIFI_FAST_CACHE_KEY       "ap"
+#define WIFI_FAST_CACHE_VERSION   1
+
+typedef struct {
+    uint8_t version;
+    char ssid[32];                  // 缓存对应的SSID，连接其他SSID时不使用
+    uint8_t bssid[6];
+    uint8_t channel;
+    esp_ip4_addr_t ip;
+    esp_ip4_addr_t netmask;
+    esp_ip4_addr_t gw;
+    esp_ip4_addr_t dns;
+} wifi_fast_cache_t;
+
+// 快速重连状态和连接耗时（只在事件处理函数和连接函数中修改）
+static struct {
+    wifi_fast_cache_t cache;
+    bool cache_valid;
+    bool directed;                  // 当前STA配置指定了缓存的BSSID和信道
+    bool static_ip;                 // 当前使用缓存的IP，DHCP客户端已停止
+    bool lease_pending;             // 已用缓存的IP连上，DHCP客户端已重新启动，等待服务器确认租约
+    esp_timer_handle_t lease_timer; // 等待租约确认的超时
+    wifi_config_t sta_config;       // 最近一次连接使用的STA配置，回退时去掉BSSID和信道重新设置
+    uint8_t bssid[6];               // 本次实际关联的AP
+    uint8_t channel;
+    int64_t request_us;             // 请求连接（或连接断开）的时间
+    int64_t attempt_us;             // 最后一次发起连接的时间
+    int64_t connected_us;           // 关联完成的时间
+    wifi_connect_timings_t timings;
+} s_fast = {0};
+
+// 缓存的Flash写入：事件处理函数只更新内存中的缓存并记录请求，NVS写入由esp_timer任务执行，不阻塞事件循环
+typedef enum {
+    WIFI_FAST_NVS_NONE,
+    WIFI_FAST_NVS_SAVE,
+    WIFI_FAST_NVS_ERASE,
+} wifi_fast_nvs_op_t;
+
+static struct {
+    esp_timer_handle_t timer;
+    wifi_fast_nvs_op_t op;          // 只保留最新的请求，执行前的多次请求合并为一次写入
+    wifi_fast_cache_t cache;        // op为WIFI_FAST_NVS_SAVE时写入的内容
+} s_nvs_work = {0};
+static portMUX_TYPE s_nvs_work_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 订阅者注册表：容量固定，通知时不分配内存
+typedef struct {
+    uint32_t event_mask;            // 关心的WIFI_MANAGER_EVENT_*事件，0表示空位
+    wifi_subscriber_cb_t callback;
+    void *ctx;
+} wifi_subscriber_t;
+
+static wifi_subscriber_t s_subscribers[WIFI_SUBSCRIBER_MAX];
+static portMUX_TYPE s_subscriber_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 兼容旧接口：set_event_callback和set_ip_callback各占一个订阅位，回调和参数分开保存
+static struct {
+    wifi_event_callback_t callback;
+    void *user_data;
+    int id;                         // 订阅编号，-1表示尚未订阅
+} s_compat_event = {.id = -1};
+
+static struct {
+    wifi_ip_callback_t callback;
+    void *user_data;
+    int id;
+} s_compat_ip = {.id = -1};
+
+// 自动重连：连接断开后由esp_timer按指数退避重新发起连接，事件处理函数不等待
+static struct {
+    esp_timer_handle_t timer;
+    SemaphoreHandle_t disconnected; // 每次处理完断开事件时释放，wifi_manager_connect()据此等待断开完成
+    bool enabled;                   // wifi_manager_disconnect()后停止自动重连
+    uint32_t delay_ms;              // 最近一次安排的等待时间
+} s_reconnect = {0};
+
 // 内部函数声明
 static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                               int32_t event_id, void* event_data);
 static void ip_event_handler(void* arg, esp_event_base_t event_base,
                             int32_t event_id, void* event_data);
-static void wifi_task(void *pvParameters);
+
+// 开始修改s_wifi_info或连接耗时，写入期间不能调用会阻塞的函数
+static void wifi_info_write_begin(void)
+{
+    wifi_seqlock_write_begin(&s_info_seqlock);
+}
+
+static void wifi_info_write_end(void)
+{
+    wifi_seqlock_write_end(&s_info_seqlock);
+}
+
+// 读取一致的快照（任一参数可为NULL），返回因并发写入而重新复制的次数
+static uint32_t wifi_info_read(wifi_info_t *info, wifi_connect_timings_t *timings)
+{
+    uint32_t retries = 0;
+    
+    while (1) {
+        unsigned seq = wifi_seqlock_read_begin(&s_info_seqlock);
+        if (!(seq & 1)) {
+            if (info) {
+                memcpy(info, &s_wifi_info, sizeof(wifi_info_t));
+            }
+            if (timings) {
+                memcpy(timings, &s_fast.timings, sizeof(wifi_connect_timings_t));
+            }
+            if (!wifi_seqlock_read_retry(&s_info_seqlock, seq)) {
+                return retries;
+            }
+        }
+        retries++;
+    }
+}
+
+// 从NVS读取快速重连缓存
+static void wifi_fast_load_cache(void)
+{
+    nvs_handle_t handle;
+    size_t len = sizeof(s_fast.cache);
+    
+    s_fast.cache_valid = false;
+    if (nvs_open(WIFI_FAST_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;     // 从未保存过
+    }
+    
+    if (nvs_get_blob(handle, WIFI_FAST_CACHE_KEY, &s_fast.cache, &len) == ESP_OK &&
+        len == sizeof(s_fast.cache) && s_fast.cache.version == WIFI_FAST_CACHE_VERSION) {
+        s_fast.cache_valid = true;
+        ESP_LOGI(TAG, "快速重连缓存: %s 信道%d IP " IPSTR, s_fast.cache.ssid, s_fast.cache.channel,
+                 IP2STR(&s_fast.cache.ip));
+    }
+    nvs_close(handle);
+}
+
+// 从NVS删除快速重连缓存（会写Flash，不能在事件处理函数中调用）
+static esp_err_t wifi_fast_nvs_erase(void)
+{
+    nvs_handle_t handle;
+    
+    esp_err_t ret = nvs_open(WIFI_FAST_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    ret = nvs_erase_key(handle, WIFI_FAST_CACHE_KEY);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    } else if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = ESP_OK;
+    }
+    nvs_close(handle);
+    return ret;
+}
+
+// 把快速重连缓存写入NVS（会写Flash，不能在事件处理函数中调用）
+static esp_err_t wifi_fast_nvs_write(const wifi_fast_cache_t *cache)
+{
+    nvs_handle_t handle;
+    
+    esp_err_t ret = nvs_open(WIFI_FAST_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    ret = nvs_set_blob(handle, WIFI_FAST_CACHE_KEY, cache, sizeof(*cache));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
+
+// 执行最新的Flash写入请求（esp_timer任务）
+static void wifi_fast_nvs_work_cb(void *arg)
+{
+    wifi_fast_cache_t cache;
+    
+    portENTER_CRITICAL(&s_nvs_work_lock);
+    wifi_fast_nvs_op_t op = s_nvs_work.op;
+    cache = s_nvs_work.cache;
+    s_nvs_work.op = WIFI_FAST_NVS_NONE;
+    portEXIT_CRITICAL(&s_nvs_work_lock);
+    
+    if (op == WIFI_FAST_NVS_SAVE) {
+        esp_err_t ret = wifi_fast_nvs_write(&cache);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "保存快速重连缓存失败: %s", esp_err_to_name(ret));
+            return;
+        }
+        ESP_LOGI(TAG, "已更新快速重连缓存: 信道%d IP " IPSTR, cache.channel, IP2STR(&cache.ip));
+    } else if (op == WIFI_FAST_NVS_ERASE) {
+        esp_err_t ret = wifi_fast_nvs_erase();
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "清除快速重连缓存失败: %s", esp_err_to_name(ret));
+        }
+    }
+}
+
+// 记录Flash写入请求并尽快在esp_timer任务中执行，不等待写入完成
+static void wifi_fast_nvs_request(wifi_fast_nvs_op_t op, const wifi_fast_cache_t *cache)
+{
+    portENTER_CRITICAL(&s_nvs_work_lock);
+    s_nvs_work.op = op;
+    if (cache) {
+        s_nvs_work.cache = *cache;
+    }
+    portEXIT_CRITICAL(&s_nvs_work_lock);
+    
+    esp_timer_stop(s_nvs_work.timer);      // 未启动时返回错误，忽略
+    esp_timer_start_once(s_nvs_work.timer, 0);
+}
+
+// 删除快速重连缓存：内存中的缓存立即失效，NVS稍后删除
+static void wifi_fast_erase_cache(void)
+{
+    s_fast.cache_valid = false;
+    wifi_fast_nvs_request(WIFI_FAST_NVS_ERASE, NULL);
+}
+
+// 保存本次连接的AP和IP租约，内容未变化时不写Flash；内存中的缓存立即更新，NVS稍后写入
+static void wifi_fast_save_cache(const esp_netif_ip_info_t *ip_info)
+{
+    wifi_fast_cache_t cache;
+    esp_netif_dns_info_t dns;
+    
+    memset(&cache, 0, sizeof(cache));
+    cache.version = WIFI_FAST_CACHE_VERSION;
+    memcpy(cache.ssid, s_fast.sta_config.sta.ssid, sizeof(cache.ssid) - 1);
+    memcpy(cache.bssid, s_fast.bssid, sizeof(cache.bssid));
+    cache.channel = s_fast.channel;
+    cache.ip = ip_info->ip;
+    cache.netmask = ip_info->netmask;
+    cache.gw = ip_info->gw;
+    if (esp_netif_get_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK) {
+        cache.dns = dns.ip.u_addr.ip4;
+    }
+    
+    if (s_fast.cache_valid && memcmp(&cache, &s_fast.cache, sizeof(cache)) == 0) {
+        return;
+    }
+    
+    s_fast.cache = cache;
+    s_fast.cache_valid = true;
+    wifi_fast_nvs_request(WIFI_FAST_NVS_SAVE, &cache);
+}
+
+// 切换缓存的静态IP和DHCP
+static void wifi_fast_set_static_ip(bool enable)
+{
+    if (enable) {
+        esp_netif_dhcpc_stop(s_sta_netif);     // 已停止时返回错误，忽略
+        esp_netif_ip_info_t ip_info = {
+            .ip = s_fast.cache.ip,
+            .netmask = s_fast.cache.netmask,
+            .gw = s_fast.cache.gw,
+        };
+        if (esp_netif_set_ip_info(s_sta_netif, &ip_info) != ESP_OK) {
+            ESP_LOGW(TAG, "设置缓存的IP失败，使用DHCP");
+            esp_netif_dhcpc_start(s_sta_netif);
+            s_fast.static_ip = false;
+            return;
+        }
+        
+        if (s_fast.cache.dns.addr != 0) {
+            esp_netif_dns_info_t dns = {0};
+            dns.ip.type = ESP_IPADDR_TYPE_V4;
+            dns.ip.u_addr.ip4 = s_fast.cache.dns;
+            esp_netif_set_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns);
+        }
+        s_fast.static_ip = true;
+    } else if (s_fast.static_ip) {
+        esp_netif_dhcpc_start(s_sta_netif);
+        s_fast.static_ip = false;
+    }
+}
+
+// 缓存的SSID与本次连接一致时，在配置中指定BSSID和信道，并使用缓存的IP
+static void wifi_fast_apply(wifi_config_t *wifi_config)
+{
+    bool use_cache = WIFI_FAST_CONNECT_ENABLE && s_fast.cache_valid &&
+                     strncmp(s_fast.cache.ssid, (char*)wifi_config->sta.ssid, sizeof(s_fast.cache.ssid)) == 0;
+    
+    s_fast.directed = use_cache;
+    if (use_cache) {
+        wifi_config->sta.bssid_set = true;
+        memcpy(wifi_config->sta.bssid, s_fast.cache.bssid, sizeof(wifi_config->sta.bssid));
+        wifi_config->sta.channel = s_fast.cache.channel;
+        ESP_LOGI(TAG, "快速连接: 信道%d%s", s_fast.cache.channel, WIFI_FAST_STATIC_IP ? "，使用缓存的IP" : "");
+    }
+    wifi_fast_set_static_ip(use_cache && WIFI_FAST_STATIC_IP);
+}
+
+// 已用缓存的IP连上：重新启动DHCP客户端续租。服务器确认同一地址时租约续期，拒绝（NAK）时lwIP重新申请，
+// 拿到的新租约覆盖缓存；WIFI_FAST_LEASE_TIMEOUT_MS内没有拿到租约时清除缓存，下次改为扫描连接和完整的DHCP
+static void wifi_fast_renew_lease(void)
+{
+    s_fast.static_ip = false;
+    s_fast.lease_pending = true;
+    esp_timer_stop(s_fast.lease_timer);     // 未启动时返回错误，忽略
+    esp_timer_start_once(s_fast.lease_timer, (uint64_t)WIFI_FAST_LEASE_TIMEOUT_MS * 1000);
+    
+    esp_err_t ret = esp_netif_dhcpc_start(s_sta_netif);
+    if (ret != ESP_OK && ret != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED) {
+        ESP_LOGW(TAG, "重新启动DHCP失败: %s", esp_err_to_name(ret));
+    }
+}
+
+// 不再等待租约确认（连接断开、回退到扫描连接）
+static void wifi_fast_cancel_lease(void)
+{
+    s_fast.lease_pending = false;
+    esp_timer_stop(s_fast.lease_timer);
+}
+
+// 租约确认超时（esp_timer任务）
+static void wifi_fast_lease_timeout_cb(void *arg)
+{
+    if (!s_fast.lease_pending) {
+        return;
+    }
+    s_fast.lease_pending = false;
+    ESP_LOGW(TAG, "DHCP在%d ms内未确认缓存的IP，清除快速重连缓存", WIFI_FAST_LEASE_TIMEOUT_MS);
+    wifi_fast_erase_cache();
+}
+
+// 定向连接失败（AP关闭、更换信道等）：清除缓存，恢复DHCP，改为扫描连接
+static void wifi_fast_fallback(void)
+{
+    ESP_LOGW(TAG, "快速连接失败，清除缓存并改为扫描连接");
+    
+    s_fast.directed = false;
+    wifi_info_write_begin();
+    s_fast.timings.fast_fallbacks++;
+    wifi_info_write_end();
+    s_fast.sta_config.sta.bssid_set = false;
+    memset(s_fast.sta_config.sta.bssid, 0, sizeof(s_fast.sta_config.sta.bssid));
+    s_fast.sta_config.sta.channel = 0;
+    esp_wifi_set_config(WIFI_IF_STA, &s_fast.sta_config);
+    wifi_fast_set_static_ip(false);
+    wifi_fast_erase_cache();
+}
+
+// 记录一次连接尝试的开始
+static void wifi_fast_begin_attempt(void)
+{
+    s_fast.attempt_us = esp_timer_get_time();
+    wifi_info_write_begin();
+    s_fast.timings.attempts++;
+    wifi_info_write_end();
+}
+
+// 第n次连续失败后的等待时间：WIFI_RECONNECT_MIN_MS每次翻倍，不超过WIFI_RECONNECT_MAX_MS，
+// 再加上±WIFI_RECONNECT_JITTER_PCT%的随机抖动，同一路由器下的多个设备断电恢复后不会同时重连
+static uint32_t wifi_reconnect_delay_ms(int failures)
+{
+    uint32_t delay = WIFI_RECONNECT_MIN_MS;
+    for (int i = 1; i < failures && delay < WIFI_RECONNECT_MAX_MS; i++) {
+        delay *= 2;
+    }
+    if (delay > WIFI_RECONNECT_MAX_MS) {
+        delay = WIFI_RECONNECT_MAX_MS;
+    }
+    
+    uint32_t jitter = delay * WIFI_RECONNECT_JITTER_PCT / 100;
+    return delay - jitter + esp_random() % (2 * jitter + 1);
+}
+
+// 安排下一次重连
+static void wifi_reconnect_schedule(void)
+{
+    s_reconnect.delay_ms = wifi_reconnect_delay_ms(s_retry_num);
+    esp_timer_stop(s_reconnect.timer);     // 未启动时返回错误，忽略
+    esp_err_t ret = esp_timer_start_once(s_reconnect.timer, (uint64_t)s_reconnect.delay_ms * 1000);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "启动重连定时器失败: %s", esp_err_to_name(ret));
+        return;
+    }
+    ESP_LOGI(TAG, "%lu ms后重试连接WiFi（连续失败%d次）", (unsigned long)s_reconnect.delay_ms, s_retry_num);
+}
+
+// 重连定时器回调（esp_timer任务）：只发起连接，结果由事件处理函数处理
+static void wifi_reconnect_timer_cb(void *arg)
+{
+    if (!s_reconnect.enabled) {
+        return;
+    }
+    
+    wifi_fast_begin_attempt();
+    esp_err_t ret = esp_wifi_connect();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "重连失败: %s", esp_err_to_name(ret));
+        wifi_reconnect_schedule();
+    }
+}
+
+// 通知订阅了该事件的订阅者：先在临界区内复制注册表，再在临界区外逐个调用，不分配内存
+// 订阅者在回调中可以订阅或取消订阅，变化从下一个事件开始生效
+static void wifi_dispatch(uint32_t event, wifi_state_t state, esp_ip4_addr_t ip_addr)
+{
+    wifi_subscriber_t subscribers[WIFI_SUBSCRIBER_MAX];
+    wifi_manager_event_t info = {
+        .event = event,
+        .state = state,
+        .ip_addr = ip_addr,
+    };
+    
+    portENTER_CRITICAL(&s_subscriber_lock);
+    memcpy(subscribers, s_subscribers, sizeof(subscribers));
+    portEXIT_CRITICAL(&s_subscriber_lock);
+    
+    for (int i = 0; i < WIFI_SUBSCRIBER_MAX; i++) {
+        if (subscribers[i].event_mask & event) {
+            subscribers[i].callback(&info, subscribers[i].ctx);
+        }
+    }
+}
+
+// 更新状态并通知订阅者：状态变化只通过这里发布，管理器没有轮询任务
+static void wifi_publish_state(wifi_state_t state)
+{
+    wifi_info_write_begin();
+    s_wifi_info.state = state;
+    wifi_info_write_end();
+    
+    wifi_dispatch(WIFI_MANAGER_EVENT_STATE, state, (esp_ip4_addr_t){0});
+}
 
 // WiFi事件处理函数
 static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                               int32_t event_id, void* event_data)
 {
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+        // 由wifi_manager_connect()发起连接，这里不再用驱动中保存的旧配置连接一次
         ESP_LOGI(TAG, "WiFi站点模式启动");
-        s_wifi_info.state = WIFI_STATE_CONNECTING;
-        esp_wifi_connect();
-        
-        if (s_event_callback) {
-            s_event_callback(s_wifi_info.state, s_user_data);
-        }
         
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
         ESP_LOGI(TAG, "WiFi连接断开");
+        wifi_info_t prev_info;
+        wifi_info_read(&prev_info, NULL);
+        wifi_state_t prev_state = prev_info.state;
+        wifi_state_t state = WIFI_STATE_DISCONNECTED;
+        
+        // 未确认的租约下次连接时再确认
+        wifi_fast_cancel_lease();
+        
+        // 状态、SSID和IP在同一次写入中清除；重连或失败状态在下面确定后再发布
+        wifi_info_write_begin();
         s_wifi_info.state = WIFI_STATE_DISCONNECTED;
         memset(s_wifi_info.ssid, 0, sizeof(s_wifi_info.ssid));
         memset(&s_wifi_info.ip_addr, 0, sizeof(s_wifi_info.ip_addr));
+        // 已连接后断开：重连耗时从现在开始计算
+        if (prev_state == WIFI_STATE_CONNECTED) {
+            s_fast.request_us = esp_timer_get_time();
+            s_fast.timings.attempts = 0;
+        }
+        wifi_info_write_end();
         
-        // 延迟重连，避免立即重连导致的问题
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        
-        if (s_retry_num < s_wifi_config.max_retry) {
-            ESP_LOGI(TAG, "重试连接WiFi... (%d/%d)", s_retry_num + 1, s_wifi_config.max_retry);
-            esp_err_t ret = esp_wifi_connect();
-            if (ret == ESP_OK) {
-                s_retry_num++;
-            } else {
-                ESP_LOGE(TAG, "重连失败: %s", esp_err_to_name(ret));
+        if (s_fast.directed && prev_state != WIFI_STATE_CONNECTED && prev_state != WIFI_STATE_DISCONNECTING) {
+            // 定向连接没有成功，缓存的AP不可用：立即扫描重连，不计入重试次数
+            wifi_fast_fallback();
+            wifi_fast_begin_attempt();
+            state = WIFI_STATE_CONNECTING;
+            esp_wifi_connect();
+        } else if (s_reconnect.enabled) {
+            // 连续失败达到max_retry后报告失败状态，但后台按退避间隔一直重试，直到连接成功或主动断开
+            s_retry_num++;
+            if (s_retry_num >= s_wifi_config.max_retry) {
+                if (prev_state != WIFI_STATE_FAILED) {
+                    ESP_LOGE(TAG, "WiFi连接失败，已连续失败%d次，后台继续重试", s_retry_num);
+                }
+                state = WIFI_STATE_FAILED;
             }
-        } else {
-            ESP_LOGE(TAG, "WiFi连接失败，达到最大重试次数");
-            s_wifi_info.state = WIFI_STATE_FAILED;
-            xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
+            wifi_reconnect_schedule();
         }
         
-        if (s_event_callback) {
-            s_event_callback(s_wifi_info.state, s_user_data);
+        // 已获取IP后断开：先通知IP丢失（网络服务可据此暂停），再通知新状态
+        if (prev_info.ip_addr.addr != 0) {
+            wifi_dispatch(WIFI_MANAGER_EVENT_LOST_IP, WIFI_STATE_DISCONNECTED, prev_info.ip_addr);
         }
+        wifi_publish_state(state);
+        xSemaphoreGive(s_reconnect.disconnected);
         
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
-        ESP_LOGI(TAG, "WiFi连接成功");
-        s_wifi_info.state = WIFI_STATE_CONNECTED;
+        wifi_event_sta_connected_t* event = (wifi_event_sta_connected_t*) event_data;
+        s_fast.connected_us = esp_timer_get_time();
+        uint32_t assoc_ms = (s_fast.connected_us - s_fast.attempt_us) / 1000;
+        memcpy(s_fast.bssid, event->bssid, sizeof(s_fast.bssid));
+        s_fast.channel = event->channel;
+        ESP_LOGI(TAG, "WiFi连接成功，关联耗时 %lu ms", (unsigned long)assoc_ms);
+        
+        // 先取AP信息，再在一次写入中更新，读者不会看到新状态配旧SSID，再通知回调
         wifi_ap_record_t ap_info;
-        if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+        bool have_ap_info = (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK);
+        
+        wifi_info_write_begin();
+        s_wifi_info.state = WIFI_STATE_CONNECTED;
+        s_fast.timings.assoc_ms = assoc_ms;
+        if (have_ap_info) {
             strncpy(s_wifi_info.ssid, (char*)ap_info.ssid, sizeof(s_wifi_info.ssid) - 1);
             s_wifi_info.rssi = ap_info.rssi;
             s_wifi_info.auth_mode = ap_info.authmode;
             s_wifi_info.channel = ap_info.primary;
         }
+        wifi_info_write_end();
         
-        if (s_event_callback) {
-            s_event_callback(s_wifi_info.state, s_user_data);
-        }
+        wifi_publish_state(WIFI_STATE_CONNECTED);
         
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_START) {
         ESP_LOGI(TAG, "WiFi AP模式启动");
@@ -108,40 +561,50 @@ static void ip_event_handler(void* arg, esp_event_base_t event_base,
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
         ESP_LOGI(TAG, "获取到IP地址: " IPSTR, IP2STR(&event->ip_info.ip));
         
-        s_wifi_info.ip_addr = event->ip_info.ip;
         s_retry_num = 0;
-        xEventGroupSetBits(s_wifi_event_group, WIFI_GOT_IP_BIT);
         
-        if (s_ip_callback) {
-            char ip_str[16];
-            snprintf(ip_str, sizeof(ip_str), IPSTR, IP2STR(&event->ip_info.ip));
-            s_ip_callback(ip_str, s_user_data);
+        if (s_fast.lease_pending) {
+            // DHCP确认了租约：连接耗时在缓存的IP生效时已经记录，地址不变时不再通知订阅者
+            wifi_fast_cancel_lease();
+            wifi_info_t prev_info;
+            wifi_info_read(&prev_info, NULL);
+            bool changed = (prev_info.ip_addr.addr != event->ip_info.ip.addr);
+            ESP_LOGI(TAG, "DHCP租约已确认%s", changed ? "，IP已改变" : "");
+            wifi_fast_save_cache(&event->ip_info);
+            if (changed) {
+                wifi_info_write_begin();
+                s_wifi_info.ip_addr = event->ip_info.ip;
+                wifi_info_write_end();
+                wifi_dispatch(WIFI_MANAGER_EVENT_GOT_IP, WIFI_STATE_CONNECTED, event->ip_info.ip);
+            }
+            return;
         }
-    }
-}
-
-// WiFi任务函数
-static void wifi_task(void *pvParameters)
-{
-    while (1) {
-        EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group,
-                                               WIFI_CONNECTED_BIT | WIFI_FAIL_BIT | WIFI_GOT_IP_BIT,
-                                               pdFALSE,
-                                               pdFALSE,
-                                               pdMS_TO_TICKS(1000));
         
-        if (bits & WIFI_CONNECTED_BIT) {
-            ESP_LOGI(TAG, "WiFi连接成功");
-            xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
-        } else if (bits & WIFI_FAIL_BIT) {
-            ESP_LOGE(TAG, "WiFi连接失败");
-            xEventGroupClearBits(s_wifi_event_group, WIFI_FAIL_BIT);
-        } else if (bits & WIFI_GOT_IP_BIT) {
-            ESP_LOGI(TAG, "获取到IP地址");
-            xEventGroupClearBits(s_wifi_event_group, WIFI_GOT_IP_BIT);
+        // IP和连接各阶段耗时一起更新
+        int64_t now = esp_timer_get_time();
+        wifi_info_write_begin();
+        s_wifi_info.ip_addr = event->ip_info.ip;
+        s_fast.timings.fast_path = s_fast.directed;
+        s_fast.timings.static_ip = s_fast.static_ip;
+        s_fast.timings.ip_ms = (now - s_fast.connected_us) / 1000;
+        s_fast.timings.total_ms = (now - s_fast.request_us) / 1000;
+        s_fast.timings.since_boot_ms = now / 1000;
+        wifi_info_write_end();
+        
+        ESP_LOGI(TAG, "%s: 关联 %lu ms | 获取IP %lu ms | 共 %lu ms（尝试%d次）",
+                 s_fast.directed ? "快速连接" : "扫描连接",
+                 (unsigned long)s_fast.timings.assoc_ms, (unsigned long)s_fast.timings.ip_ms,
+                 (unsigned long)s_fast.timings.total_ms, s_fast.timings.attempts);
+        
+        if (s_fast.static_ip) {
+            // 缓存的IP未经服务器确认，不写回缓存；重新启动DHCP续租，确认后再保存
+            wifi_fast_renew_lease();
+        } else {
+            // 记录本次的AP和租约，供下次快速连接
+            wifi_fast_save_cache(&event->ip_info);
         }
         
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        wifi_dispatch(WIFI_MANAGER_EVENT_GOT_IP, WIFI_STATE_CONNECTED, event->ip_info.ip);
     }
 }
 
@@ -155,13 +618,6 @@ esp_err_t wifi_manager_init(void)
     
     ESP_LOGI(TAG, "初始化WiFi管理器");
     
-    // 创建事件组
-    s_wifi_event_group = xEventGroupCreate();
-    if (s_wifi_event_group == NULL) {
-        ESP_LOGE(TAG, "创建事件组失败");
-        return ESP_ERR_NO_MEM;
-    }
-    
     // 初始化TCP/IP适配器
     ESP_ERROR_CHECK(esp_netif_init());
     
@@ -176,6 +632,28 @@ esp_err_t wifi_manager_init(void)
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
     
+    // 创建重连定时器
+    const esp_timer_create_args_t timer_args = {
+        .callback = wifi_reconnect_timer_cb,
+        .name = "wifi_reconnect",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &s_reconnect.timer));
+    const esp_timer_create_args_t lease_timer_args = {
+        .callback = wifi_fast_lease_timeout_cb,
+        .name = "wifi_lease",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&lease_timer_args, &s_fast.lease_timer));
+    const esp_timer_create_args_t nvs_timer_args = {
+        .callback = wifi_fast_nvs_work_cb,
+        .name = "wifi_nvs",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&nvs_timer_args, &s_nvs_work.timer));
+    s_reconnect.disconnected = xSemaphoreCreateBinary();
+    if (!s_reconnect.disconnected) {
+        ESP_LOGE(TAG, "创建信号量失败");
+        return ESP_ERR_NO_MEM;
+    }
+    
     // 注册事件处理函数
     ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
                                                        ESP_EVENT_ANY_ID,
@@ -198,15 +676,21 @@ esp_err_t wifi_manager_init(void)
     memset(&s_wifi_info, 0, sizeof(s_wifi_info));
     s_wifi_info.state = WIFI_STATE_DISCONNECTED;
     
-    // 启动WiFi
+    // 读取快速重连缓存（需要先初始化NVS）
+    wifi_fast_load_cache();
+    
+    // 启动WiFi：每次连接都会设置配置，驱动不需要再把配置写入Flash
+    ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_start());
     
-    // 创建WiFi任务
-    xTaskCreate(wifi_task, "wifi_task", 4096, NULL, 5, NULL);
-    
+    // 不创建任务：状态变化在事件处理函数中直接通知回调，重连由定时器触发，空闲时没有任何唤醒
     s_manager_initialized = true;
-    ESP_LOGI(TAG, "WiFi管理器初始化完成");
+    ESP_LOGI(TAG, "WiFi管理器初始化完成（事件驱动，无轮询任务）：少%d个任务，节省%u字节堆内存"
+             "（每个任务%d字节堆栈 + %u字节TCB），空闲唤醒减少%d.%d次/秒",
+             WIFI_REMOVED_TASKS, (unsigned)(WIFI_REMOVED_TASKS * (WIFI_REMOVED_TASK_STACK + sizeof(StaticTask_t))),
+             WIFI_REMOVED_TASK_STACK, (unsigned)sizeof(StaticTask_t),
+             WIFI_REMOVED_WAKEUPS_PER_10S / 10, WIFI_REMOVED_WAKEUPS_PER_10S % 10);
     
     return ESP_OK;
 }
@@ -220,9 +704,33 @@ esp_err_t wifi_manager_deinit(void)
     
     ESP_LOGI(TAG, "反初始化WiFi管理器");
     
+    // 停止自动重连
+    s_reconnect.enabled = false;
+    if (s_reconnect.timer) {
+        esp_timer_stop(s_reconnect.timer);
+        esp_timer_delete(s_reconnect.timer);
+        s_reconnect.timer = NULL;
+    }
+    if (s_fast.lease_timer) {
+        wifi_fast_cancel_lease();
+        esp_timer_delete(s_fast.lease_timer);
+        s_fast.lease_timer = NULL;
+    }
+    if (s_nvs_work.timer) {
+        // 还没执行的写入在这里完成，缓存不会丢失
+        esp_timer_stop(s_nvs_work.timer);
+        esp_timer_delete(s_nvs_work.timer);
+        s_nvs_work.timer = NULL;
+        wifi_fast_nvs_work_cb(NULL);
+    }
+    
     // 停止WiFi
     ESP_ERROR_CHECK(esp_wifi_stop());
     ESP_ERROR_CHECK(esp_wifi_deinit());
+    if (s_reconnect.disconnected) {
+        vSemaphoreDelete(s_reconnect.disconnected);
+        s_reconnect.disconnected = NULL;
+    }
     
     // 删除网络接口
     if (s_sta_netif) {
@@ -234,12 +742,6 @@ esp_err_t wifi_manager_deinit(void)
         s_ap_netif = NULL;
     }
     
-    // 删除事件组
-    if (s_wifi_event_group) {
-        vEventGroupDelete(s_wifi_event_group);
-        s_wifi_event_group = NULL;
-    }
-    
     s_manager_initialized = false;
     ESP_LOGI(TAG, "WiFi管理器反初始化完成");
     
@@ -259,11 +761,19 @@ esp_err_t wifi_manager_connect(const char *ssid, const char *password)
         return ESP_ERR_INVALID_ARG;
     }
     
-    // 检查WiFi状态，如果正在连接则先断开
-    if (s_wifi_info.state == WIFI_STATE_CONNECTING || s_wifi_info.state == WIFI_STATE_CONNECTED) {
+    // 检查WiFi状态，如果正在连接则先断开，等断开事件处理完再开始新的连接，
+    // 否则迟到的断开事件会计入新连接的失败次数并安排多余的重连（不要在订阅回调中调用）
+    wifi_state_t state = wifi_manager_get_state();
+    if (state == WIFI_STATE_CONNECTING || state == WIFI_STATE_CONNECTED) {
         ESP_LOGI(TAG, "WiFi正在连接或已连接，先断开连接");
-        esp_wifi_disconnect();
-        vTaskDelay(pdMS_TO_TICKS(100)); // 等待断开完成
+        s_fast.directed = false;
+        s_reconnect.enabled = false;
+        esp_timer_stop(s_reconnect.timer);
+        xSemaphoreTake(s_reconnect.disconnected, 0);    // 清除之前的断开事件
+        if (esp_wifi_disconnect() == ESP_OK &&
+            xSemaphoreTake(s_reconnect.disconnected, pdMS_TO_TICKS(WIFI_EVENT_TIMEOUT_MS)) != pdTRUE) {
+            ESP_LOGW(TAG, "%d ms内未收到断开事件", WIFI_EVENT_TIMEOUT_MS);
+        }
     }
     
     ESP_LOGI(TAG, "连接WiFi: %s", ssid);
@@ -282,6 +792,14 @@ esp_err_t wifi_manager_connect(const char *ssid, const char *password)
     strncpy((char*)wifi_config.sta.ssid, ssid, sizeof(wifi_config.sta.ssid) - 1);
     strncpy((char*)wifi_config.sta.password, password, sizeof(wifi_config.sta.password) - 1);
     
+    // 有同一SSID的缓存时定向连接
+    s_fast.request_us = esp_timer_get_time();
+    wifi_info_write_begin();
+    s_fast.timings.attempts = 0;
+    wifi_info_write_end();
+    wifi_fast_apply(&wifi_config);
+    s_fast.sta_config = wifi_config;
+    
     // 设置WiFi配置
     esp_err_t ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
     if (ret != ESP_OK) {
@@ -289,22 +807,20 @@ esp_err_t wifi_manager_connect(const char *ssid, const char *password)
         return ret;
     }
     
-    // 清除事件位
-    xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT | WIFI_GOT_IP_BIT);
+    // 取消尚未执行的重连，重新开始退避
+    esp_timer_stop(s_reconnect.timer);
+    s_reconnect.enabled = true;
+    s_retry_num = 0;
     
     // 连接WiFi
+    wifi_fast_begin_attempt();
     ret = esp_wifi_connect();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "连接WiFi失败: %s", esp_err_to_name(ret));
         return ret;
     }
     
-    s_wifi_info.state = WIFI_STATE_CONNECTING;
-    s_retry_num = 0;
-    
-    if (s_event_callback) {
-        s_event_callback(s_wifi_info.state, s_user_data);
-    }
+    wifi_publish_state(WIFI_STATE_CONNECTING);
     
     return ESP_OK;
 }
@@ -319,12 +835,13 @@ esp_err_t wifi_manager_disconnect(void)
     
     ESP_LOGI(TAG, "断开WiFi连接");
     
-    s_wifi_info.state = WIFI_STATE_DISCONNECTING;
-    ESP_ERROR_CHECK(esp_wifi_disconnect());
+    // 主动断开后不再自动重连
+    s_reconnect.enabled = false;
+    esp_timer_stop(s_reconnect.timer);
     
-    if (s_event_callback) {
-        s_event_callback(s_wifi_info.state, s_user_data);
-    }
+    // 先发布断开中状态，断开事件据此判断是主动断开
+    wifi_publish_state(WIFI_STATE_DISCONNECTING);
+    ESP_ERROR_CHECK(esp_wifi_disconnect());
     
     return ESP_OK;
 }
@@ -339,7 +856,10 @@ esp_err_t wifi_manager_reconnect(void)
     
     ESP_LOGI(TAG, "重新连接WiFi");
     
+    esp_timer_stop(s_reconnect.timer);
+    s_reconnect.enabled = true;
     s_retry_num = 0;
+    wifi_fast_begin_attempt();
     ESP_ERROR_CHECK(esp_wifi_connect());
     
     return ESP_OK;
@@ -372,7 +892,7 @@ esp_err_t wifi_manager_get_config(wifi_manager_config_t *config)
     return ESP_OK;
 }
 
-// 获取WiFi信息
+// 获取WiFi信息（一致的快照，不会阻塞事件循环）
 esp_err_t wifi_manager_get_info(wifi_info_t *info)
 {
     if (!info) {
@@ -380,49 +900,172 @@ esp_err_t wifi_manager_get_info(wifi_info_t *info)
         return ESP_ERR_INVALID_ARG;
     }
     
-    memcpy(info, &s_wifi_info, sizeof(wifi_info_t));
+    wifi_info_read(info, NULL);
     return ESP_OK;
 }
 
 // 获取WiFi状态
 wifi_state_t wifi_manager_get_state(void)
 {
-    return s_wifi_info.state;
+    wifi_info_t info;
+    wifi_info_read(&info, NULL);
+    return info.state;
 }
 
 // 检查WiFi是否已连接
 bool wifi_manager_is_connected(void)
 {
-    return (s_wifi_info.state == WIFI_STATE_CONNECTED);
+    return (wifi_manager_get_state() == WIFI_STATE_CONNECTED);
+}
+
+// 获取IP地址字符串，写入调用者的缓冲区（WIFI_IP_STRING_LEN字节足够）并返回该缓冲区
+const char* wifi_manager_get_ip_string(char *buf, size_t len)
+{
+    if (!buf || len == 0) {
+        return NULL;
+    }
+    
+    wifi_info_t info;
+    wifi_info_read(&info, NULL);
+    if (info.state == WIFI_STATE_CONNECTED) {
+        snprintf(buf, len, IPSTR, IP2STR(&info.ip_addr));
+    } else {
+        snprintf(buf, len, "未连接");
+    }
+    return buf;
+}
+
+// 订阅事件：event_mask为WIFI_MANAGER_EVENT_*的组合，subscriber_id可为NULL
+esp_err_t wifi_manager_subscribe(uint32_t event_mask, wifi_subscriber_cb_t callback, void *ctx, int *subscriber_id)
+{
+    if (!callback || !(event_mask & WIFI_MANAGER_EVENT_ALL)) {
+        ESP_LOGE(TAG, "订阅参数无效");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    int id = -1;
+    portENTER_CRITICAL(&s_subscriber_lock);
+    for (int i = 0; i < WIFI_SUBSCRIBER_MAX; i++) {
+        if (s_subscribers[i].event_mask == 0) {
+            s_subscribers[i].callback = callback;
+            s_subscribers[i].ctx = ctx;
+            s_subscribers[i].event_mask = event_mask & WIFI_MANAGER_EVENT_ALL;
+            id = i;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_subscriber_lock);
+    
+    if (id < 0) {
+        ESP_LOGE(TAG, "订阅者已满（最多%d个）", WIFI_SUBSCRIBER_MAX);
+        return ESP_ERR_NO_MEM;
+    }
+    if (subscriber_id) {
+        *subscriber_id = id;
+    }
+    return ESP_OK;
+}
+
+// 取消订阅
+esp_err_t wifi_manager_unsubscribe(int subscriber_id)
+{
+    if (subscriber_id < 0 || subscriber_id >= WIFI_SUBSCRIBER_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    portENTER_CRITICAL(&s_subscriber_lock);
+    bool found = (s_subscribers[subscriber_id].event_mask != 0);
+    memset(&s_subscribers[subscriber_id], 0, sizeof(wifi_subscriber_t));
+    portEXIT_CRITICAL(&s_subscriber_lock);
+    
+    return found ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+// 兼容旧接口的订阅者
+static void wifi_compat_event_cb(const wifi_manager_event_t *event, void *ctx)
+{
+    portENTER_CRITICAL(&s_subscriber_lock);
+    wifi_event_callback_t callback = s_compat_event.callback;
+    void *user_data = s_compat_event.user_data;
+    portEXIT_CRITICAL(&s_subscriber_lock);
+    
+    if (callback) {
+        callback(event->state, user_data);
+    }
 }
 
-// 获取IP地址字符串
-const char* wifi_manager_get_ip_string(void)
+static void wifi_compat_ip_cb(const wifi_manager_event_t *event, void *ctx)
 {
-    static char ip_str[16];
-    if (s_wifi_info.state == WIFI_STATE_CONNECTED) {
-        snprintf(ip_str, sizeof(ip_str), IPSTR, IP2STR(&s_wifi_info.ip_addr));
-        return ip_str;
+    portENTER_CRITICAL(&s_subscriber_lock);
+    wifi_ip_callback_t callback = s_compat_ip.callback;
+    void *user_data = s_compat_ip.user_data;
+    portEXIT_CRITICAL(&s_subscriber_lock);
+    
+    if (callback) {
+        char ip_str[WIFI_IP_STRING_LEN];
+        snprintf(ip_str, sizeof(ip_str), IPSTR, IP2STR(&event->ip_addr));
+        callback(ip_str, user_data);
     }
-    return "未连接";
 }
 
-// 设置事件回调函数
+// 设置事件回调函数（兼容接口，新代码使用wifi_manager_subscribe）：再次设置时替换之前的回调
 esp_err_t wifi_manager_set_event_callback(wifi_event_callback_t callback, void *user_data)
 {
-    s_event_callback = callback;
-    s_user_data = user_data;
+    portENTER_CRITICAL(&s_subscriber_lock);
+    s_compat_event.callback = callback;
+    s_compat_event.user_data = user_data;
+    portEXIT_CRITICAL(&s_subscriber_lock);
+    
+    if (s_compat_event.id < 0) {
+        return wifi_manager_subscribe(WIFI_MANAGER_EVENT_STATE, wifi_compat_event_cb, NULL, &s_compat_event.id);
+    }
     return ESP_OK;
 }
 
-// 设置IP回调函数
+// 设置IP回调函数（兼容接口），与事件回调的user_data各自独立
 esp_err_t wifi_manager_set_ip_callback(wifi_ip_callback_t callback, void *user_data)
 {
-    s_ip_callback = callback;
-    s_user_data = user_data;
+    portENTER_CRITICAL(&s_subscriber_lock);
+    s_compat_ip.callback = callback;
+    s_compat_ip.user_data = user_data;
+    portEXIT_CRITICAL(&s_subscriber_lock);
+    
+    if (s_compat_ip.id < 0) {
+        return wifi_manager_subscribe(WIFI_MANAGER_EVENT_GOT_IP, wifi_compat_ip_cb, NULL, &s_compat_ip.id);
+    }
+    return ESP_OK;
+}
+
+// 获取最近一次连接的各阶段耗时
+esp_err_t wifi_manager_get_timings(wifi_connect_timings_t *timings)
+{
+    if (!timings) {
+        ESP_LOGE(TAG, "耗时参数为空");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    wifi_info_read(NULL, timings);
     return ESP_OK;
 }
 
+// 清除快速重连缓存，下次连接时扫描并重新获取DHCP租约
+esp_err_t wifi_manager_clear_cache(void)
+{
+    if (!s_manager_initialized) {
+        ESP_LOGE(TAG, "WiFi管理器未初始化");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    ESP_LOGI(TAG, "清除快速重连缓存");
+    
+    // 在调用者的任务中直接删除，丢弃尚未执行的写入请求
+    s_fast.cache_valid = false;
+    portENTER_CRITICAL(&s_nvs_work_lock);
+    s_nvs_work.op = WIFI_FAST_NVS_NONE;
+    portEXIT_CRITICAL(&s_nvs_work_lock);
+    return wifi_fast_nvs_erase();
+}
+
 // 使用默认配置连接WiFi
 esp_err_t wifi_manager_connect_default(void)
 {
@@ -484,3 +1127,141 @@ esp_err_t wifi_manager_stop_ap(void)
     
     return ESP_OK;
 }
+
+// 快照测试的共享状态
+static struct {
+    uint32_t count;                 // 每个写入任务的写入次数
+    atomic_int writers;             // 仍在运行的写入任务
+    uint32_t reads[2];              // [0]为调用者，[1]为读取任务
+    uint32_t retries[2];
+    uint32_t torn[2];
+    TaskHandle_t waiter;
+} s_snapshot_test;
+
+// 写入序号n对应的记录：每个字段都由n决定，读者据此检查快照是否一致
+static void wifi_test_fill(uint32_t n)
+{
+    s_wifi_info.state = (wifi_state_t)(n % 5);
+    memset(s_wifi_info.ssid, 'A' + n % 26, sizeof(s_wifi_info.ssid) - 1);
+    s_wifi_info.ssid[sizeof(s_wifi_info.ssid) - 1] = '\0';
+    s_wifi_info.rssi = -(int8_t)(n % 100);
+    s_wifi_info.channel = n % 13 + 1;
+    s_wifi_info.ip_addr.addr = n;
+    s_fast.timings.attempts = (uint8_t)n;
+    s_fast.timings.total_ms = n;
+}
+
+static bool wifi_test_check(const wifi_info_t *info, const wifi_connect_timings_t *timings)
+{
+    uint32_t n = info->ip_addr.addr;
+    
+    if (info->state != (wifi_state_t)(n % 5) || info->rssi != -(int8_t)(n % 100) ||
+        info->channel != n % 13 + 1 || timings->attempts != (uint8_t)n || timings->total_ms != n) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(info->ssid) - 1; i++) {
+        if (info->ssid[i] != (char)('A' + n % 26)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 写入任务：arg为起始序号，两个写入任务的序号不重叠
+static void wifi_test_writer_task(void *arg)
+{
+    uint32_t first = (uint32_t)(uintptr_t)arg;
+    
+    for (uint32_t i = 0; i < s_snapshot_test.count; i++) {
+        wifi_info_write_begin();
+        wifi_test_fill(first + i);
+        wifi_info_write_end();
+        if ((i & 15) == 0) {
+            taskYIELD();
+        }
+    }
+    atomic_fetch_sub(&s_snapshot_test.writers, 1);
+    vTaskDelete(NULL);
+}
+
+// 写入任务全部结束前一直读取并检查
+static void wifi_test_read_loop(int reader)
+{
+    wifi_info_t info;
+    wifi_connect_timings_t timings;
+    
+    while (atomic_load(&s_snapshot_test.writers) > 0) {
+        s_snapshot_test.retries[reader] += wifi_info_read(&info, &timings);
+        s_snapshot_test.reads[reader]++;
+        if (!wifi_test_check(&info, &timings)) {
+            if (s_snapshot_test.torn[reader]++ == 0) {
+                ESP_LOGE(TAG, "读到不一致的快照: IP=%lu 状态=%d 信道=%d",
+                         (unsigned long)info.ip_addr.addr, info.state, info.channel);
+            }
+        }
+    }
+}
+
+static void wifi_test_reader_task(void *arg)
+{
+    wifi_test_read_loop(1);
+    xTaskNotifyGive(s_snapshot_test.waiter);
+    vTaskDelete(NULL);
+}
+
+// 快照压力测试：两个写入任务和两个读者（调用者和一个读取任务）同优先级并发运行
+bool wifi_manager_test_snapshot(uint32_t iterations)
+{
+    if (s_manager_initialized) {
+        ESP_LOGE(TAG, "WiFi管理器运行时不能进行快照测试");
+        return false;
+    }
+    if (iterations == 0) {
+        return false;
+    }
+    
+    // 测试结束后恢复原记录
+    wifi_info_t saved_info;
+    wifi_connect_timings_t saved_timings;
+    wifi_info_read(&saved_info, &saved_timings);
+    
+    memset(&s_snapshot_test, 0, sizeof(s_snapshot_test));
+    s_snapshot_test.count = iterations;
+    s_snapshot_test.waiter = xTaskGetCurrentTaskHandle();
+    wifi_info_write_begin();
+    wifi_test_fill(0);
+    wifi_info_write_end();
+    
+    UBaseType_t priority = uxTaskPriorityGet(NULL);
+    atomic_store(&s_snapshot_test.writers, 2);
+    for (uint32_t i = 0; i < 2; i++) {
+        if (xTaskCreate(wifi_test_writer_task, "wifi_test_w", 2048, (void *)(uintptr_t)(1 + i * iterations),
+                        priority, NULL) != pdPASS) {
+            atomic_fetch_sub(&s_snapshot_test.writers, 1);
+        }
+    }
+    bool reader_started = (xTaskCreate(wifi_test_reader_task, "wifi_test_r", 2048, NULL, priority, NULL) == pdPASS);
+    
+    int64_t start = esp_timer_get_time();
+    wifi_test_read_loop(0);
+    int64_t elapsed_us = esp_timer_get_time() - start;
+    if (reader_started) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    
+    wifi_info_write_begin();
+    s_wifi_info = saved_info;
+    s_fast.timings = saved_timings;
+    wifi_info_write_end();
+    
+    uint32_t reads = s_snapshot_test.reads[0] + s_snapshot_test.reads[1];
+    uint32_t retries = s_snapshot_test.retries[0] + s_snapshot_test.retries[1];
+    uint32_t torn = s_snapshot_test.torn[0] + s_snapshot_test.torn[1];
+    ESP_LOGI(TAG, "写入 %lu 次，读取 %lu 次（因并发写入重读 %lu 次），不一致 %lu 次，平均每次读取 %lu ns",
+             (unsigned long)(2 * iterations), (unsigned long)reads, (unsigned long)retries, (unsigned long)torn,
+             (unsigned long)(s_snapshot_test.reads[0] ? elapsed_us * 1000 / s_snapshot_test.reads[0] : 0));
+    
+    bool passed = (torn == 0 && reads > 0 && reader_started);
+    ESP_LOGI(TAG, "状态快照自检%s", passed ? "通过" : "失败");
+    return passed;
+}
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
@@ -16,7 +17,7 @@ extern "C" {
 typedef struct {
     char ssid[32];           // WiFi名称
     char password[64];       // WiFi密码
-    uint8_t max_retry;       // 最大重试次数
+    uint8_t max_retry;       // 连续失败该次数后报告失败状态（后台继续重试）
     uint32_t timeout_ms;     // 连接超时时间（毫秒）
 } wifi_manager_config_t;
 
@@ -25,7 +26,7 @@ typedef enum {
     WIFI_STATE_DISCONNECTED = 0,    // 未连接
     WIFI_STATE_CONNECTING,          // 连接中
     WIFI_STATE_CONNECTED,           // 已连接
-    WIFI_STATE_FAILED,              // 连接失败
+    WIFI_STATE_FAILED,              // 连续失败达到max_retry（后台仍在重试）
     WIFI_STATE_DISCONNECTING        // 断开连接中
 } wifi_state_t;
 
@@ -39,11 +40,45 @@ typedef struct {
     esp_ip4_addr_t ip_addr;        // IP地址
 } wifi_info_t;
 
-// 回调函数类型定义
+// 最近一次连接的各阶段耗时
+// 驱动把802.11认证、关联和WPA握手合并为一个WIFI_EVENT_STA_CONNECTED事件，因此认证和关联计为一个阶段
+typedef struct {
+    bool fast_path;                 // 使用缓存的BSSID和信道定向连接（跳过扫描）
+    bool static_ip;                 // 先使用缓存的IP（不等DHCP），连上后再由DHCP续租确认
+    uint8_t attempts;               // 本次连接的尝试次数（含快速连接失败后的全扫描）
+    uint32_t assoc_ms;              // 最后一次尝试从发起到认证、关联完成（含扫描）
+    uint32_t ip_ms;                 // 从关联完成到获取IP
+    uint32_t total_ms;              // 从请求连接到获取IP
+    uint32_t since_boot_ms;         // 获取IP时距启动的时间
+    uint32_t fast_fallbacks;        // 累计：快速连接失败、回退到全扫描的次数
+} wifi_connect_timings_t;
+
+// IP地址字符串缓冲区大小（"255.255.255.255"加结束符）
+#define WIFI_IP_STRING_LEN  16
+
+// 订阅事件
+#define WIFI_MANAGER_EVENT_STATE    (1 << 0)    // 连接状态变化
+#define WIFI_MANAGER_EVENT_GOT_IP   (1 << 1)    // 获取到IP（含快速连接使用缓存的IP）
+#define WIFI_MANAGER_EVENT_LOST_IP  (1 << 2)    // 已获取IP后连接断开
+#define WIFI_MANAGER_EVENT_ALL      (WIFI_MANAGER_EVENT_STATE | WIFI_MANAGER_EVENT_GOT_IP | WIFI_MANAGER_EVENT_LOST_IP)
+
+// 传给订阅者的事件
+typedef struct {
+    uint32_t event;                 // 本次事件（一个WIFI_MANAGER_EVENT_*位）
+    wifi_state_t state;             // 事件发生后的状态
+    esp_ip4_addr_t ip_addr;         // GOT_IP为新获取的IP，LOST_IP为丢失的IP，STATE为0
+} wifi_manager_event_t;
+
+// 订阅者回调：通常在默认事件循环任务中调用（主动连接、断开时在调用者任务中），不能阻塞
+typedef void (*wifi_subscriber_cb_t)(const wifi_manager_event_t *event, void *ctx);
+
+// 回调函数类型定义（兼容接口）
 typedef void (*wifi_event_callback_t)(wifi_state_t state, void *user_data);
 typedef void (*wifi_ip_callback_t)(const char *ip_addr, void *user_data);
 
 // 函数声明
+// 状态查询（get_info、get_state、is_connected、get_ip_string、get_timings）可在任意任务中调用：
+// 读取的是一致的快照，不加锁、不阻塞事件循环
 esp_err_t wifi_manager_init(void);
 esp_err_t wifi_manager_deinit(void);
 esp_err_t wifi_manager_connect(const char *ssid, const char *password);
@@ -54,10 +89,24 @@ esp_err_t wifi_manager_get_config(wifi_manager_config_t *config);
 esp_err_t wifi_manager_get_info(wifi_info_t *info);
 wifi_state_t wifi_manager_get_state(void);
 bool wifi_manager_is_connected(void);
-const char* wifi_manager_get_ip_string(void);
+const char* wifi_manager_get_ip_string(char *buf, size_t len);
+
+// 订阅者注册表：最多WIFI_SUBSCRIBER_MAX个订阅者，各自有上下文和事件掩码，可在初始化前订阅
+esp_err_t wifi_manager_subscribe(uint32_t event_mask, wifi_subscriber_cb_t callback, void *ctx, int *subscriber_id);
+esp_err_t wifi_manager_unsubscribe(int subscriber_id);
+
+// 兼容接口：各占一个订阅位，再次设置时替换之前的回调
 esp_err_t wifi_manager_set_event_callback(wifi_event_callback_t callback, void *user_data);
 esp_err_t wifi_manager_set_ip_callback(wifi_ip_callback_t callback, void *user_data);
 
+// 快速重连：每次成功获取IP后把AP的BSSID、信道和IP租约存入NVS，下次连接同一SSID时直接使用
+esp_err_t wifi_manager_get_timings(wifi_connect_timings_t *timings);
+esp_err_t wifi_manager_clear_cache(void);
+
+// 测试函数：两个任务交替写入有规律的状态记录，调用者和另一个任务同时读取，检查每个快照都是一致的
+// 必须在wifi_manager_init()之前调用
+bool wifi_manager_test_snapshot(uint32_t iterations);
+
 // 便捷函数
 esp_err_t wifi_manager_connect_default(void);
 esp_err_t wifi_manager_start_ap(const char *ssid, const char *password, uint8_t channel);
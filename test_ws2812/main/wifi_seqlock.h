@@ -0,0 +1,57 @@
+#ifndef WIFI_SEQLOCK_H
+#define WIFI_SEQLOCK_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 发布序号（seqlock）：写入者在临界区内把序号加到奇数、修改、再加到偶数，
+// 读者无锁复制后检查序号没有变化，被写入打断时重新复制，不会阻塞写入者，也不会读到一半新一半旧的记录
+// 只依赖C11原子操作和portMUX，可以在开发机上用pthreads测试（见host/test_seqlock.c）
+
+typedef struct {
+    atomic_uint seq;                    // 偶数表示没有写入在进行
+    portMUX_TYPE lock;                  // 写入者之间互斥
+} wifi_seqlock_t;
+
+// 静态初始化
+#define WIFI_SEQLOCK_INIT       {.seq = 0, .lock = portMUX_INITIALIZER_UNLOCKED}
+
+// 开始修改受保护的数据，写入期间不能调用会阻塞的函数
+static inline void wifi_seqlock_write_begin(wifi_seqlock_t *sl)
+{
+    portENTER_CRITICAL(&sl->lock);
+    atomic_store_explicit(&sl->seq, atomic_load_explicit(&sl->seq, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void wifi_seqlock_write_end(wifi_seqlock_t *sl)
+{
+    atomic_store_explicit(&sl->seq, atomic_load_explicit(&sl->seq, memory_order_relaxed) + 1,
+                          memory_order_release);
+    portEXIT_CRITICAL(&sl->lock);
+}
+
+// 读者：复制前取序号，奇数表示写入正在进行，需要稍后重试
+static inline unsigned wifi_seqlock_read_begin(wifi_seqlock_t *sl)
+{
+    return atomic_load_explicit(&sl->seq, memory_order_acquire);
+}
+
+// 读者：复制后检查，返回true表示复制期间有写入，需要重新复制
+static inline bool wifi_seqlock_read_retry(wifi_seqlock_t *sl, unsigned seq)
+{
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&sl->seq, memory_order_relaxed) != seq;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WIFI_SEQLOCK_H
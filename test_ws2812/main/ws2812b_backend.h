@@ -0,0 +1,112 @@
+#ifndef WS2812B_BACKEND_H
+#define WS2812B_BACKEND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_attr.h"
+#include "ws2812b_driver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// WS2812B 发送后端内部接口（仅供驱动内部使用）
+// RMT与SPI后端实现同一组操作，由ws2812b_strip_new()按配置选择
+// ============================================================================
+
+// 编码相关代码运行在中断中，流式发送长灯带时放入IRAM，避免Flash缓存失效导致补充数据不及时
+#if WS2812B_ENCODER_IN_IRAM
+#define WS2812B_ENCODER_ATTR  IRAM_ATTR
+#define WS2812B_ENCODER_DATA  DRAM_ATTR
+#else
+#define WS2812B_ENCODER_ATTR
+#define WS2812B_ENCODER_DATA
+#endif
+
+// 发送完成通知（可能在中断上下文中调用，返回值表示是否唤醒了更高优先级任务）
+typedef bool (*ws2812b_backend_done_cb_t)(void *user_ctx);
+
+// 后端配置
+typedef struct {
+    gpio_num_t gpio_num;                // 数据引脚
+    uint16_t led_count;                 // LED数量
+    ws2812b_color_order_t color_order;  // 线上颜色顺序
+    const ws2812b_chip_t *chip;         // 芯片配置（时序、每像素字节数）
+    size_t mem_block_symbols;           // RMT：内存块符号数，0表示使用默认值
+    bool streaming;                     // RMT：流式模式
+    spi_host_device_t spi_host;         // SPI：使用的SPI主机
+    ws2812b_backend_done_cb_t on_done;  // 发送完成通知
+    void *user_ctx;                     // 通知上下文
+} ws2812b_backend_config_t;
+
+// 后端对象
+typedef struct ws2812b_backend_t ws2812b_backend_t;
+struct ws2812b_backend_t {
+    // 发送一帧像素数据（每像素bytes_per_pixel字节，按RGB(W)保存），每个字节按颜色顺序取出并经lut查表后输出
+    // lut为NULL时像素已是线上顺序且已应用亮度（紧凑模式），按原样发送
+    // 调用前上一帧必须已发送完成，像素数据和lut在发送完成前保持不变
+    esp_err_t (*transmit)(ws2812b_backend_t *backend, const void *pixels, size_t size,
+                          const uint8_t *lut, bool nonblocking);
+    // 等待已提交的帧发送完成
+    esp_err_t (*wait_done)(ws2812b_backend_t *backend, int timeout_ms);
+    // 获取发送欠载次数
+    uint32_t (*get_underruns)(ws2812b_backend_t *backend);
+    // 删除后端
+    esp_err_t (*del)(ws2812b_backend_t *backend);
+};
+
+// RMT：纳秒/微秒转换为RMT时钟节拍（四舍五入），RMT编码器和位时序计算共用
+#define WS2812B_NS_TO_TICKS(ns)  ((((ns) * (WS2812B_RMT_RESOLUTION_HZ / 1000000)) + 500) / 1000)
+#define WS2812B_US_TO_TICKS(us)  ((us) * (WS2812B_RMT_RESOLUTION_HZ / 1000000))
+
+// SPI：每个WS2812B位展开为3个SPI位（0 -> 100，1 -> 110）
+// SPI时钟2.5MHz时每个SPI位400ns：0码 400ns高/800ns低，1码 800ns高/400ns低
+#define WS2812B_SPI_BITS_PER_BIT   3
+#define WS2812B_SPI_PATTERN_0      0x4     // 0b100
+#define WS2812B_SPI_PATTERN_1      0x6     // 0b110
+
+// 每个像素字节展开后的SPI字节数（8位 × 3 = 24位）
+#define WS2812B_SPI_BYTES_PER_BYTE 3
+
+// SPI位流的高电平时间（纳秒），芯片时序与之相差不超过容差才能使用SPI后端
+#define WS2812B_SPI_BIT_NS         (1000000000 / WS2812B_SPI_CLOCK_HZ)
+#define WS2812B_SPI_T0H_NS         (WS2812B_SPI_BIT_NS * 1)
+#define WS2812B_SPI_T1H_NS         (WS2812B_SPI_BIT_NS * 2)
+#define WS2812B_SPI_TOLERANCE_NS   150
+
+// 复位码对应的SPI字节数（全0），按预定义芯片中最长的复位时间（WS2812B/WS2815）计算
+#define WS2812B_SPI_RESET_BYTES \
+    (((uint64_t)WS2812B_RESET_TIME_US * WS2812B_SPI_CLOCK_HZ / 1000000 + 7) / 8)
+
+// 各颜色顺序下，线上第n个字节在像素中的偏移（第4个字节为RGBW芯片的白色通道）
+extern const uint8_t ws2812b_order_map[WS2812B_ORDER_MAX][4];
+
+// 伽马校正表与亮度/伽马组合查找表生成
+extern const uint8_t ws2812b_gamma_table[256];
+void ws2812b_build_lut(uint8_t *lut, uint8_t brightness, bool gamma);
+
+// 16位帧带时间抖动地量化为8位（error为每通道的量化误差，跨帧保留）
+void ws2812b_dither_frame(const ws2812b_color16_t *src, uint8_t *dst, uint8_t *error,
+                          uint16_t led_count, uint32_t scale, bool gamma);
+
+// 创建后端
+esp_err_t ws2812b_new_rmt_backend(const ws2812b_backend_config_t *config, ws2812b_backend_t **ret_backend);
+esp_err_t ws2812b_new_spi_backend(const ws2812b_backend_config_t *config, ws2812b_backend_t **ret_backend);
+
+// 线上编码（ws2812b_encode.c）：只用到标准C，不依赖外设驱动，在开发机上测试（host/test_waveform.c）
+// RMT编码器实际使用的位时序（纳秒）
+void ws2812b_rmt_bit_timing(const ws2812b_chip_t *chip, int bit, uint32_t *high_ns, uint32_t *low_ns);
+
+// SPI位展开：每个WS2812B位展开为3个SPI位，供SPI后端和波形测试共用
+size_t ws2812b_spi_frame_size(uint16_t led_count, uint8_t bytes_per_pixel);
+void ws2812b_spi_encode_frame(const void *pixels, size_t size, const uint8_t *order, uint8_t bytes_per_pixel,
+                              const uint8_t *lut, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS2812B_BACKEND_H
@@ -0,0 +1,91 @@
+#include "ws2812b_color.h"
+
+// HSV转RGB：色相分6段，段内位置取8位，每通道只需几次乘法和移位
+ws2812b_color_t ws2812b_color_from_hsv(uint16_t hue, uint8_t saturation, uint8_t value)
+{
+    uint32_t h6 = (uint32_t)hue * 6;
+    uint8_t sector = h6 >> 16;
+    uint8_t f = (h6 >> 8) & 0xFF;
+    
+    uint8_t p = ws2812b_scale8(value, 255 - saturation);
+    uint8_t q = ws2812b_scale8(value, 255 - ws2812b_scale8(saturation, f));
+    uint8_t t = ws2812b_scale8(value, 255 - ws2812b_scale8(saturation, 255 - f));
+    
+    switch (sector) {
+    case 0:  return (ws2812b_color_t){value, t, p, 0};
+    case 1:  return (ws2812b_color_t){q, value, p, 0};
+    case 2:  return (ws2812b_color_t){p, value, t, 0};
+    case 3:  return (ws2812b_color_t){p, q, value, 0};
+    case 4:  return (ws2812b_color_t){t, p, value, 0};
+    default: return (ws2812b_color_t){value, p, q, 0};
+    }
+}
+
+// HSL转RGB：先换算为HSV再转换
+ws2812b_color_t ws2812b_color_from_hsl(uint16_t hue, uint8_t saturation, uint8_t lightness)
+{
+    uint8_t chroma_half = lightness < 128 ? lightness : 255 - lightness;
+    uint32_t value = lightness + ws2812b_scale8(saturation, chroma_half);
+    uint32_t hsv_saturation = 0;
+    
+    if (value > 0) {
+        hsv_saturation = (2 * (value - lightness) * 255 + value / 2) / value;
+        if (hsv_saturation > 255) {
+            hsv_saturation = 255;
+        }
+    }
+    
+    return ws2812b_color_from_hsv(hue, (uint8_t)hsv_saturation, (uint8_t)value);
+}
+
+// 按比例缩放亮度（scale=255不变）
+ws2812b_color_t ws2812b_color_scale(ws2812b_color_t color, uint8_t scale)
+{
+    return (ws2812b_color_t){
+        ws2812b_scale8(color.red, scale),
+        ws2812b_scale8(color.green, scale),
+        ws2812b_scale8(color.blue, scale),
+        ws2812b_scale8(color.white, scale),
+    };
+}
+
+// 两种颜色混合：amount=0为a，amount=255为b
+ws2812b_color_t ws2812b_color_blend(ws2812b_color_t a, ws2812b_color_t b, uint8_t amount)
+{
+    return (ws2812b_color_t){
+        ws2812b_lerp8(a.red, b.red, amount),
+        ws2812b_lerp8(a.green, b.green, amount),
+        ws2812b_lerp8(a.blue, b.blue, amount),
+        ws2812b_lerp8(a.white, b.white, amount),
+    };
+}
+
+// 饱和加法：各通道相加，超过255时取255
+ws2812b_color_t ws2812b_color_add(ws2812b_color_t a, ws2812b_color_t b)
+{
+    uint32_t red = a.red + b.red;
+    uint32_t green = a.green + b.green;
+    uint32_t blue = a.blue + b.blue;
+    uint32_t white = a.white + b.white;
+    
+    return (ws2812b_color_t){
+        red > 255 ? 255 : red,
+        green > 255 ? 255 : green,
+        blue > 255 ? 255 : blue,
+        white > 255 ? 255 : white,
+    };
+}
+
+// 调整饱和度：saturation=0为同亮度的灰色，255不变（白色通道不参与）
+ws2812b_color_t ws2812b_color_saturate(ws2812b_color_t color, uint8_t saturation)
+{
+    // 亮度按BT.709系数（54/183/19，和为256）
+    uint8_t gray = (54 * color.red + 183 * color.green + 19 * color.blue) >> 8;
+    
+    return (ws2812b_color_t){
+        ws2812b_lerp8(gray, color.red, saturation),
+        ws2812b_lerp8(gray, color.green, saturation),
+        ws2812b_lerp8(gray, color.blue, saturation),
+        color.white,
+    };
+}
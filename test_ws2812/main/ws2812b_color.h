@@ -0,0 +1,52 @@
+#ifndef WS2812B_COLOR_H
+#define WS2812B_COLOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ws2812b_driver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 颜色运算：全部为定点整数运算（ESP32-C3没有FPU），每通道只有乘法、加法和移位
+
+// 色相：0-65535对应一整圈（0=红，约21845=绿，约43690=蓝）
+#define WS2812B_HUE_RED      0
+#define WS2812B_HUE_GREEN    21845
+#define WS2812B_HUE_BLUE     43690
+
+// x / 255（四舍五入），x不超过65025（255×255，乘积和插值的最大值）时结果精确
+static inline uint8_t ws2812b_div255(uint32_t x)
+{
+    x += 128;
+    return (uint8_t)((x + (x >> 8)) >> 8);
+}
+
+// 8位插值：t=0返回a，t=255返回b
+static inline uint8_t ws2812b_lerp8(uint8_t a, uint8_t b, uint8_t t)
+{
+    return ws2812b_div255((uint32_t)a * (255 - t) + (uint32_t)b * t);
+}
+
+// 8位缩放：value * scale / 255
+static inline uint8_t ws2812b_scale8(uint8_t value, uint8_t scale)
+{
+    return ws2812b_div255((uint32_t)value * scale);
+}
+
+// 颜色空间转换
+ws2812b_color_t ws2812b_color_from_hsv(uint16_t hue, uint8_t saturation, uint8_t value);
+ws2812b_color_t ws2812b_color_from_hsl(uint16_t hue, uint8_t saturation, uint8_t lightness);
+
+// 颜色运算
+ws2812b_color_t ws2812b_color_scale(ws2812b_color_t color, uint8_t scale);
+ws2812b_color_t ws2812b_color_blend(ws2812b_color_t a, ws2812b_color_t b, uint8_t amount);
+ws2812b_color_t ws2812b_color_add(ws2812b_color_t a, ws2812b_color_t b);
+ws2812b_color_t ws2812b_color_saturate(ws2812b_color_t color, uint8_t saturation);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS2812B_COLOR_H
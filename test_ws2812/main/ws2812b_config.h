@@ -9,7 +9,8 @@
 #define WS2812B_GPIO_PIN        GPIO_NUM_10    // 数据引脚，可根据实际连接修改
 
 // LED数量配置
-#define WS2812B_LED_COUNT       1             // LED数量，当前为1个
+#define WS2812B_LED_COUNT       1             // ws2812b_init()创建的默认灯带LED数量，当前为1个
+                                              // 其他长度的灯带请用ws2812b_strip_new()在运行时指定
 
 // 时序参数配置（单位：纳秒）
 #define WS2812B_T0H_NS         350           // 0码高电平时间
@@ -20,20 +21,44 @@
 
 // RMT外设配置
 #define WS2812B_RMT_RESOLUTION_HZ  10000000  // RMT分辨率：10MHz
-#define WS2812B_RMT_MEM_BLOCK_SYMBOLS  64    // RMT内存块符号数
-#define WS2812B_RMT_TRANS_QUEUE_DEPTH  4     // 传输队列深度
+#define WS2812B_RMT_MEM_BLOCK_SYMBOLS  48    // RMT内存块符号数（ESP32-C3每通道48个，超过会占用相邻通道）
+#define WS2812B_RMT_TRANS_QUEUE_DEPTH  1     // 传输队列深度：双缓冲下同一时刻只有一帧在发送，提交前先等上一帧完成
+#define WS2812B_MAX_STRIPS         3         // 最多同时驱动的灯带数（ESP32-C3：2个RMT发送通道 + 1个SPI2）
+
+// SPI后端配置
+#define WS2812B_SPI_CLOCK_HZ       2500000   // SPI时钟：2.5MHz，每个SPI位400ns，3个SPI位对应1个WS2812B位
+
+// 流式发送配置（长灯带，flags.streaming = 1）
+#define WS2812B_RMT_STREAM_MEM_SYMBOLS   192   // 流式模式内存块符号数（ESP32-C3全部4个内存块，独占RMT）
+#define WS2812B_RMT_DMA_MEM_SYMBOLS      1024  // 支持RMT DMA的目标上的DMA缓冲符号数
+#define WS2812B_RMT_STREAM_INTR_PRIORITY 3     // 流式模式RMT中断优先级（1-3）
+#define WS2812B_ENCODER_IN_IRAM          1     // 编码器放入IRAM：1=启用，0=禁用
+#define WS2812B_STREAM_UNDERRUN_CHECK    1     // 统计RMT补充数据欠载次数：1=启用，0=禁用
 
 // 测试效果配置
 #define WS2812B_TEST_DELAY_MS      1000      // 基本颜色测试间隔（毫秒）
-#define WS2812B_RAINBOW_DELAY_MS  50         // 彩虹效果间隔（毫秒）
-#define WS2812B_FADE_DELAY_MS     20         // 渐变效果间隔（毫秒）
-#define WS2812B_BLINK_DELAY_MS    200        // 闪烁效果间隔（毫秒）
+#define WS2812B_RAINBOW_DELAY_MS  50         // 彩虹效果：每前进一个色相的时间（毫秒）
+#define WS2812B_FADE_DELAY_MS     20         // 渐变效果：每变化一级亮度的时间（毫秒）
+#define WS2812B_BLINK_DELAY_MS    200        // 闪烁效果：亮/灭各持续的时间（毫秒）
 #define WS2812B_BREATH_STEP       5          // 呼吸灯步进值
-#define WS2812B_BREATH_DELAY_MS   30         // 呼吸灯间隔（毫秒）
+#define WS2812B_BREATH_DELAY_MS   30         // 呼吸灯：每步进一次的时间（毫秒）
+
+// 效果引擎配置
+#define WS2812B_EFFECT_FPS        50         // 渲染任务目标帧率（0=按灯带长度取最高帧率）
+#define WS2812B_EFFECT_MAX        8          // 最多可注册的效果数（含5个内置效果）
+#define WS2812B_PALETTE_MAX       16         // 调色板最多颜色数
+
+// 网络控制配置（E1.31 / Art-Net / DDP）
+#define WS2812B_DMX_START_UNIVERSE 1         // 灯带第一个LED所在的宇宙
+#define WS2812B_DMX_TIMEOUT_MS     2500      // 超过该时间没有数据视为数据源停止（E1.31规定2.5秒）
+#define WS2812B_DDP_TIMEOUT_MS     2500      // DDP：超过该时间没有数据视为数据源停止
+#define WS2812B_HTTP_PORT          80        // HTTP控制接口端口
 
 // 颜色配置
 #define WS2812B_DEFAULT_BRIGHTNESS  255      // 默认亮度（0-255）
-#define WS2812B_COLOR_ORDER_GRB    1         // 颜色顺序：1=GRB（标准），0=RGB
+#define WS2812B_GAMMA_ENABLE       1         // 伽马校正（γ=2.8）：1=启用，0=禁用
+#define WS2812B_COLOR_ORDER        WS2812B_ORDER_GRB  // 颜色顺序：GRB（标准）、RGB、BRG、RBG、GBR、BGR
+#define WS2812B_SKIP_UNCHANGED     1         // 帧内容未变化时跳过刷新：1=启用，0=每次都整帧发送
 
 // 调试配置
 #define WS2812B_DEBUG_ENABLE       1         // 启用调试输出：1=启用，0=禁用
@@ -44,12 +69,18 @@
 // ============================================================================
 
 // 任务配置
-#define WS2812B_TASK_STACK_SIZE    4096      // 测试任务堆栈大小
-#define WS2812B_TASK_PRIORITY      5         // 测试任务优先级
+#define WS2812B_TASK_STACK_SIZE    4096      // 效果渲染任务堆栈大小
+#define WS2812B_TASK_PRIORITY      5         // 效果渲染任务优先级
+#define WS2812B_DMX_TASK_STACK_SIZE 4096     // DMX接收任务堆栈大小
+#define WS2812B_DMX_TASK_PRIORITY  6         // DMX接收任务优先级（高于渲染任务，避免网络缓冲区积压）
+#define WS2812B_DMX_MAX_UNIVERSES  32        // 一条灯带最多占用的宇宙数（RGB灯带32个宇宙为5440个LED）
+#define WS2812B_DDP_TASK_STACK_SIZE 4096     // DDP接收任务堆栈大小
+#define WS2812B_DDP_TASK_PRIORITY  6         // DDP接收任务优先级
+#define WS2812B_DDP_RX_QUEUE_LEN   8         // DDP raw API路径：等待处理的数据包数（每个占用一个WiFi接收缓冲区）
+#define WS2812B_HTTP_TASK_STACK_SIZE 4096    // HTTP服务器任务堆栈大小
 
 // 内存配置
 #define WS2812B_MAX_COLORS         256       // 最大颜色数量
-#define WS2812B_COLOR_BUFFER_SIZE  (WS2812B_LED_COUNT * 3)  // 颜色缓冲区大小
 
 // 错误处理配置
 #define WS2812B_MAX_RETRY_COUNT    3         // 最大重试次数
@@ -89,17 +120,95 @@
    - 单位：ns（纳秒）
 
 3. LED数量：
-   - 当前配置为1个LED
-   - 如需控制多个LED，修改WS2812B_LED_COUNT
-   - 注意：LED数量越多，需要的内存越多
+   - 当前配置为1个LED，仅用于ws2812b_init()创建的默认灯带
+   - 同一固件驱动不同长度的灯带时，用ws2812b_strip_new()在运行时指定led_count
+   - 帧缓冲区按实际LED数量分配（每个LED占2帧×3字节），不再按最大长度预留
 
 4. 测试效果：
-   - 可以调整各种效果的延迟时间
+   - 效果由ws2812b_effect.c中的渲染任务按WS2812B_EFFECT_FPS驱动，不再阻塞调用者
+   - 帧周期由esp_timer定时器产生（微秒精度），不受FreeRTOS节拍限制
+   - 最高帧率由整帧线上时间决定：约 1000000 / (LED数量 × 24位 × 位周期 + 复位时间)，超过时自动降到最高帧率
+   - 每帧的调度时刻和截止时刻通过ws2812b_effect_frame_t传给效果，统计中包含唤醒抖动和超时帧数
+   - 各效果按经过时间计算画面，上面的间隔决定动画速度，与实际帧率无关
    - 呼吸灯步进值越小，效果越平滑
 
 5. 颜色顺序：
    - WS2812B标准使用GRB顺序
    - 如果颜色显示错误，可能需要调整此参数
+   - 编码器在发送时按此顺序取字节，像素缓冲区始终按RGB存储
+
+6. 多灯带：
+   - 每条灯带独占一个RMT发送通道或SPI主机，ESP32-C3最多2条RMT + 1条SPI
+   - 两条灯带同时使用时，每条的mem_block_symbols不能超过48
+   - ws2812b_refresh_all()背靠背启动所有通道，总延迟等于最长灯带的发送时间
+
+7. 长灯带流式发送：
+   - RMT每发完半个内存块就要在中断中补充数据，中断被WiFi等延迟时会欠载导致闪烁
+   - flags.streaming = 1时占用全部RMT内存（192个符号），补充间隔从约28us放宽到约110us
+   - 流式模式独占RMT，不能再创建第二条灯带
+   - 建议在menuconfig中启用RMT中断IRAM安全选项，配合WS2812B_ENCODER_IN_IRAM使用
+   - ws2812b_test_stream_stress()可在WiFi工作时统计欠载次数
+
+8. SPI后端：
+   - backend = WS2812B_BACKEND_SPI时用SPI的MOSI引脚输出，整帧经DMA发送，不占用RMT通道
+   - 每个LED需要9字节DMA缓冲区，另加约88字节复位码
+   - 0码 400ns高/800ns低，1码 800ns高/400ns低，均在WS2812B时序容差内
+   - SPI位展开和RMT位时序是纯C（ws2812b_encode.c），host/test_waveform.c比较两种后端对同一帧产生的波形
+
+9. 亮度与伽马：
+   - 像素缓冲区保存原始颜色，亮度和伽马校正在编码时通过256字节查找表一次完成
+   - 查找表只在ws2812b_strip_set_brightness()/ws2812b_strip_set_gamma()时重建，发送时每字节只查一次表
+   - 修改亮度不需要重写像素，下一帧生效；正在发送的帧继续使用旧表
+
+10. 时间抖动：
+   - flags.dithering = 1时像素按16位保存（每个LED额外9字节），发送前量化为8位，量化误差带到下一帧
+   - 伽马和亮度在16位下计算，每通道只有查表插值、乘法和移位
+   - 抖动靠多帧平均，需要持续高速刷新（建议100fps以上），否则低亮度下会看到闪烁
+
+11. 紧凑模式：
+   - flags.packed = 1时缓冲区直接保存线上顺序（如GRB）、已应用亮度/伽马的字节
+   - RMT发送时整帧交给字节编码器，不再逐字节查表换序；写像素时完成一次转换
+   - 修改亮度只影响之后写入的像素，需要重新渲染整帧才能整体生效
+   - ws2812b_strip_fill()/ws2812b_strip_set_pixels()/ws2812b_strip_write_raw()直接操作缓冲区
+
+12. 芯片配置：
+   - 灯带配置中的chip指定芯片时序、复位时间、每像素字节数和线上顺序，NULL为WS2812B（上面的时序宏）
+   - 预定义ws2812b_chip_sk6812_rgbw（4字节/像素，GRBW）和ws2812b_chip_ws2815（复位280us）
+   - RMT编码函数按每像素字节数分别生成，创建时选定，发送时没有额外判断
+   - SPI后端的高电平只能是400ns或800ns，不支持SK6812的时序；抖动模式只支持3字节/像素
+
+13. 跳过未变化的帧：
+   - 驱动记录自上次发送以来被写过的像素范围，刷新时只比较这一段，内容相同则不发送
+   - 只有前面一段变化时只发送到最后一个变化的像素为止，后面的LED保持原来的颜色
+   - 修改亮度/伽马或调用ws2812b_strip_invalidate()后下一帧整帧发送；跳过的帧不触发发送完成回调
+   - 灯带可能被干扰或单独断电时，可定期调用ws2812b_strip_invalidate()或把WS2812B_SKIP_UNCHANGED设为0
+
+14. E1.31 / Art-Net：
+   - ws2812b_dmx_start()在UDP 5568（E1.31，自动加入各宇宙的组播组）和6454（Art-Net）端口接收
+   - 每个宇宙512个通道按R、G、B（RGBW灯带再加W）依次对应LED，RGB灯带每宇宙170个LED
+   - 收齐灯带占用的所有宇宙后提交一帧；同一宇宙重复到达或数据源超时时提交未收齐的帧
+   - 通道数据从接收缓冲区直接写入灯带后台缓冲区，没有中间数组
+   - 数据包解析和序号规则在host/test_dmx.c中测试；ws2812b_dmx_test_receiver()不经过网络验证丢包/乱序统计和帧提交
+
+15. DDP：
+   - ws2812b_ddp_start()在UDP 4048端口接收，数据按包内字节偏移写入后台缓冲区，偏移需按像素对齐
+   - 收到带PUSH标志的包才提交显示，一帧拆成多个包时整帧切换；同一帧内的包可以任意顺序到达
+   - 丢失的包不等待重传，对应区域保留上一帧内容；只丢弃属于已经PUSH的帧的迟到包，避免写进下一帧
+   - 只处理目标ID为1（默认输出）和255（全部）的数据包，查询/配置类请求忽略
+   - ws2812b_ddp_test_receiver()不经过网络验证解析、乱序提交、丢包/乱序统计
+   - 默认通过lwIP raw API接收：tcpip线程只把pbuf放入队列，接收任务从pbuf链直接解码写入后台缓冲区，
+     省去套接字的邮箱转发和recv()整包拷贝；跨pbuf的像素单独拼接
+   - 配置use_socket = true时改用BSD套接字；两种路径在实际网络流量下的差别尚未在硬件上测量，
+     可分别运行后比较ws2812b_ddp_get_stats()中的每包处理耗时
+   - ws2812b_ddp_test_pbuf_decode()只比较整包拷贝后解码与从pbuf链直接解码，不包含套接字层的开销
+
+16. HTTP控制接口：
+   - ws2812b_http_start()启动esp_http_server，接口列表见ws2812b_http.h
+   - 上传的整帧直接接收到三缓冲的空闲槽位，发布时只交换一个原子变量；渲染任务每帧开始时取最新的一帧，
+     双方都不加锁、不等待，上传比渲染快时旧帧被覆盖（计入frames_overwritten）
+   - 亮度和调色板同样只写请求，由渲染任务在帧边界应用，HTTP处理不会阻塞渲染
+   - 帧缓冲区为3 × LED数 × 每像素字节数，第一次启动时分配
+   - ws2812b_http_get_stats()返回请求处理耗时、上传吞吐量和交接延迟；ws2812b_http_test_handoff()检查三缓冲交接
 */
 
 #endif // WS2812B_CONFIG_H
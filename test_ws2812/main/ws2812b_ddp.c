@@ -0,0 +1,907 @@
+#include "ws2812b_ddp.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "lwip/sockets.h"
+#include "lwip/udp.h"
+#include "lwip/pbuf.h"
+#include "esp_netif.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include <string.h>
+
+static const char *TAG = "WS2812B_DDP";
+
+#define WS2812B_DDP_PORT            4048
+
+// DDP包头：10字节，带时间码时为14字节
+#define DDP_FLAGS_OFFSET            0
+#define DDP_SEQUENCE_OFFSET         1
+#define DDP_TYPE_OFFSET             2
+#define DDP_ID_OFFSET               3
+#define DDP_DATA_OFFSET_OFFSET      4
+#define DDP_LENGTH_OFFSET           8
+#define DDP_HEADER_LEN              10
+#define DDP_HEADER_LEN_TIMECODE     14
+
+#define DDP_FLAG_VERSION_MASK       0xC0
+#define DDP_FLAG_VERSION_1          0x40
+#define DDP_FLAG_TIMECODE           0x10
+#define DDP_FLAG_STORAGE            0x08
+#define DDP_FLAG_REPLY              0x04
+#define DDP_FLAG_QUERY              0x02
+#define DDP_FLAG_PUSH               0x01
+#define DDP_SEQUENCE_MASK           0x0F
+
+// 目标设备ID：只接受默认输出和广播，其余（控制、配置、状态等）忽略
+#define DDP_ID_DEFAULT              1
+#define DDP_ID_ALL                  255
+
+// 以太网MTU下的最大UDP负载
+#define WS2812B_DDP_RX_BUFFER_SIZE  1472
+
+// 序号只有15个取值（1-15循环），比最新序号前进不超过该值视为新包，否则视为乱序到达的旧包
+#define WS2812B_DDP_SEQUENCE_WINDOW 8
+
+// 接收器（全局唯一）
+static struct {
+    ws2812b_ddp_config_t config;
+    uint8_t bytes_per_pixel;
+    uint8_t last_sequence;                              // 最新的序号，0表示尚未记录
+    uint8_t push_sequence;                              // 上一次PUSH的序号，0表示还没有PUSH
+    uint16_t seen;                                      // 上一次PUSH之后收到的序号（第n位对应序号n）
+    uint32_t pending_dropped;                           // 本次PUSH时按序号推算丢失的包数
+    bool pending_reordered;                             // 当前包乱序到达（序号落后但属于尚未PUSH的帧）
+    bool active;                                        // 是否正在收到数据
+    int64_t window_start;                               // 包速率统计周期起点
+    uint32_t window_packets;
+    uint64_t window_decode_us;                          // 统计周期内的处理耗时之和
+    ws2812b_ddp_stats_t stats;
+    int socket;                                         // 套接字路径
+    struct udp_pcb *pcb;                                // raw API路径的控制块
+    QueueHandle_t rx_queue;                             // raw API路径：tcpip线程转交的pbuf
+    TaskHandle_t task;
+    TaskHandle_t stop_waiter;                           // 等待接收任务退出的任务
+    volatile bool running;
+    portMUX_TYPE lock;
+    uint8_t rx_buffer[WS2812B_DDP_RX_BUFFER_SIZE];      // 接收缓冲区，解析后直接从这里写入灯带
+} s_ddp = {
+    .socket = -1,
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+// 解析一个UDP负载
+esp_err_t ws2812b_ddp_parse(const uint8_t *buf, size_t len, ws2812b_ddp_packet_t *packet)
+{
+    if (!buf || !packet || len < DDP_HEADER_LEN ||
+        (buf[DDP_FLAGS_OFFSET] & DDP_FLAG_VERSION_MASK) != DDP_FLAG_VERSION_1) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    uint8_t flags = buf[DDP_FLAGS_OFFSET];
+    size_t header_len = (flags & DDP_FLAG_TIMECODE) ? DDP_HEADER_LEN_TIMECODE : DDP_HEADER_LEN;
+    uint16_t length = (uint16_t)(buf[DDP_LENGTH_OFFSET] << 8 | buf[DDP_LENGTH_OFFSET + 1]);
+    if (header_len + length > len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    const uint8_t *p = buf + DDP_DATA_OFFSET_OFFSET;
+    packet->flags = flags;
+    packet->sequence = buf[DDP_SEQUENCE_OFFSET] & DDP_SEQUENCE_MASK;
+    packet->data_type = buf[DDP_TYPE_OFFSET];
+    packet->destination = buf[DDP_ID_OFFSET];
+    packet->offset = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+    packet->push = flags & DDP_FLAG_PUSH;
+    packet->data = buf + header_len;
+    packet->length = length;
+    return ESP_OK;
+}
+
+static void ws2812b_ddp_count_invalid(void)
+{
+    portENTER_CRITICAL(&s_ddp.lock);
+    s_ddp.stats.invalid_packets++;
+    portEXIT_CRITICAL(&s_ddp.lock);
+}
+
+// 数据源状态变化
+static void ws2812b_ddp_set_active(bool active)
+{
+    if (s_ddp.active == active) {
+        return;
+    }
+    s_ddp.active = active;
+    ESP_LOGI(TAG, "数据源%s", active ? "开始发送" : "已停止");
+    if (s_ddp.config.on_source) {
+        s_ddp.config.on_source(active, s_ddp.config.user_ctx);
+    }
+}
+
+// 序号a比b前进的步数（0-14）
+static inline uint8_t ws2812b_ddp_sequence_diff(uint8_t a, uint8_t b)
+{
+    return (a + 15 - b) % 15;
+}
+
+// 序号检查，返回false表示丢弃：
+// 比最新序号前进（不超过窗口）的是新包；落后的包只要在上一次PUSH之后就属于尚未提交的帧，乱序到达也照常写入；
+// 在上一次PUSH之前（含PUSH本身重复到达）的属于已经提交的帧，写入会污染下一帧，丢弃
+static bool ws2812b_ddp_check_sequence(uint8_t sequence)
+{
+    s_ddp.pending_reordered = false;
+    if (sequence == 0) {
+        return true;        // 发送方不使用序号
+    }
+    if (s_ddp.last_sequence != 0) {
+        uint8_t ahead = ws2812b_ddp_sequence_diff(sequence, s_ddp.last_sequence);
+        if (ahead == 0 || ahead > WS2812B_DDP_SEQUENCE_WINDOW) {
+            uint8_t since_push = ws2812b_ddp_sequence_diff(sequence, s_ddp.push_sequence);
+            uint8_t span = ws2812b_ddp_sequence_diff(s_ddp.last_sequence, s_ddp.push_sequence);
+            bool open_frame = (ahead != 0) && (s_ddp.push_sequence == 0 || (since_push > 0 && since_push < span));
+            if (!open_frame) {
+                portENTER_CRITICAL(&s_ddp.lock);
+                s_ddp.stats.late_packets++;
+                portEXIT_CRITICAL(&s_ddp.lock);
+                return false;
+            }
+            s_ddp.pending_reordered = true;
+        }
+    }
+    if (!s_ddp.pending_reordered) {
+        s_ddp.last_sequence = sequence;
+    }
+    s_ddp.seen |= 1u << sequence;
+    return true;
+}
+
+// PUSH：上一次PUSH之后到本次PUSH之间没有收到的序号计为丢包，之后的序号（下一帧提前到达的包）保留
+static void ws2812b_ddp_commit_sequence(uint8_t sequence)
+{
+    if (sequence == 0) {
+        return;
+    }
+    
+    // 第一次PUSH之前不知道帧从哪个序号开始，不统计
+    if (s_ddp.push_sequence != 0) {
+        uint8_t steps = ws2812b_ddp_sequence_diff(sequence, s_ddp.push_sequence);
+        uint8_t seq = s_ddp.push_sequence;
+        for (uint8_t i = 0; i < steps; i++) {
+            seq = seq % 15 + 1;
+            if (!(s_ddp.seen & (1u << seq))) {
+                s_ddp.pending_dropped++;
+            }
+        }
+    }
+    
+    // 只保留本次PUSH之后、最新序号之前（含）的记录
+    uint16_t keep = 0;
+    uint8_t seq = sequence;
+    for (uint8_t i = ws2812b_ddp_sequence_diff(s_ddp.last_sequence, sequence); i > 0; i--) {
+        seq = seq % 15 + 1;
+        keep |= 1u << seq;
+    }
+    s_ddp.seen &= keep;
+    s_ddp.push_sequence = sequence;
+}
+
+// 检查数据包并计算写入范围，返回false表示丢弃
+// 每个包自带偏移，同一帧内的包可以任意顺序到达；丢失的包对应的区域保留上一帧内容，不会阻塞后续帧
+static bool ws2812b_ddp_accept(const ws2812b_ddp_packet_t *packet, uint16_t *first, uint16_t *count)
+{
+    // 查询、应答和存储类请求不处理；其他目标设备的包直接忽略
+    if (packet->flags & (DDP_FLAG_QUERY | DDP_FLAG_REPLY | DDP_FLAG_STORAGE) ||
+        (packet->destination != DDP_ID_DEFAULT && packet->destination != DDP_ID_ALL)) {
+        return false;
+    }
+    
+    // 偏移必须按像素对齐并落在灯带内（只带PUSH的空包除外）
+    uint16_t led_count = ws2812b_strip_get_led_count(s_ddp.config.strip);
+    uint32_t pixel = packet->offset / s_ddp.bytes_per_pixel;
+    if (packet->length > 0 && (packet->offset % s_ddp.bytes_per_pixel != 0 || pixel >= led_count)) {
+        ws2812b_ddp_count_invalid();
+        return false;
+    }
+    
+    if (!ws2812b_ddp_check_sequence(packet->sequence)) {
+        return false;
+    }
+    if (packet->push) {
+        ws2812b_ddp_commit_sequence(packet->sequence);
+    }
+    
+    ws2812b_ddp_set_active(true);
+    
+    // 不足一个像素的尾部忽略
+    uint32_t pixels = packet->length / s_ddp.bytes_per_pixel;
+    *first = (uint16_t)pixel;
+    *count = (uint16_t)(pixels < (uint32_t)(led_count - pixel) ? pixels : (uint32_t)(led_count - pixel));
+    return true;
+}
+
+// 灯带互斥锁（未配置时不加锁）
+static inline void ws2812b_ddp_lock_strip(void)
+{
+    if (s_ddp.config.strip_lock) {
+        xSemaphoreTake(s_ddp.config.strip_lock, portMAX_DELAY);
+    }
+}
+
+static inline void ws2812b_ddp_unlock_strip(void)
+{
+    if (s_ddp.config.strip_lock) {
+        xSemaphoreGive(s_ddp.config.strip_lock);
+    }
+}
+
+// 数据写入后：带PUSH标志时提交显示，更新统计
+static void ws2812b_ddp_finish(const ws2812b_ddp_packet_t *packet)
+{
+    // 异步提交：只等待上一帧发送完成，不等待本帧
+    if (packet->push) {
+        ws2812b_strip_refresh_async(s_ddp.config.strip);
+    }
+    
+    portENTER_CRITICAL(&s_ddp.lock);
+    s_ddp.stats.packets++;
+    s_ddp.stats.dropped_packets += s_ddp.pending_dropped;
+    if (s_ddp.pending_reordered) {
+        s_ddp.stats.reordered_packets++;
+    }
+    if (packet->push) {
+        s_ddp.stats.frames++;
+    }
+    portEXIT_CRITICAL(&s_ddp.lock);
+    s_ddp.pending_dropped = 0;
+}
+
+// 处理连续缓冲区中的数据包（套接字接收路径）
+static void ws2812b_ddp_handle_packet(const uint8_t *buf, size_t len)
+{
+    ws2812b_ddp_packet_t packet;
+    uint16_t first, count;
+    
+    if (ws2812b_ddp_parse(buf, len, &packet) != ESP_OK) {
+        ws2812b_ddp_count_invalid();
+        return;
+    }
+    if (!ws2812b_ddp_accept(&packet, &first, &count)) {
+        return;
+    }
+    
+    // 从接收缓冲区直接写入后台缓冲区
+    ws2812b_ddp_lock_strip();
+    if (count > 0) {
+        ws2812b_strip_write_channels(s_ddp.config.strip, first, packet.data, count);
+    }
+    ws2812b_ddp_finish(&packet);
+    ws2812b_ddp_unlock_strip();
+}
+
+// 处理pbuf链中的数据包（raw API接收路径）：像素直接从各pbuf的负载写入后台缓冲区，不拷贝整包
+// 跨两个pbuf的像素先拼到临时数组再写入
+static void ws2812b_ddp_handle_pbuf(struct pbuf *p)
+{
+    uint8_t header[DDP_HEADER_LEN_TIMECODE];
+    const uint8_t *head = p->payload;
+    ws2812b_ddp_packet_t packet;
+    uint16_t first, count;
+    
+    // 包头一般在第一个pbuf内，不在时才拷贝出来
+    if (p->len < sizeof(header) && p->len < p->tot_len) {
+        pbuf_copy_partial(p, header, sizeof(header), 0);
+        head = header;
+    }
+    if (ws2812b_ddp_parse(head, p->tot_len, &packet) != ESP_OK) {
+        ws2812b_ddp_count_invalid();
+        return;
+    }
+    if (!ws2812b_ddp_accept(&packet, &first, &count)) {
+        return;
+    }
+    
+    uint8_t bpp = s_ddp.bytes_per_pixel;
+    uint8_t partial[4];
+    uint8_t partial_len = 0;
+    size_t skip = packet.data - head;
+    ws2812b_ddp_lock_strip();
+    for (struct pbuf *q = p; q && count > 0; q = q->next) {
+        const uint8_t *data = q->payload;
+        size_t len = q->len;
+        if (skip >= len) {
+            skip -= len;
+            continue;
+        }
+        data += skip;
+        len -= skip;
+        skip = 0;
+        
+        // 补齐上一个pbuf末尾剩下的半个像素
+        if (partial_len > 0) {
+            size_t take = (size_t)(bpp - partial_len) < len ? (size_t)(bpp - partial_len) : len;
+            memcpy(partial + partial_len, data, take);
+            partial_len += take;
+            data += take;
+            len -= take;
+            if (partial_len < bpp) {
+                continue;
+            }
+            ws2812b_strip_write_channels(s_ddp.config.strip, first++, partial, 1);
+            count--;
+            partial_len = 0;
+        }
+        
+        // 本pbuf内的整像素直接写入
+        size_t pixels = len / bpp;
+        if (pixels > count) {
+            pixels = count;
+        }
+        if (pixels > 0) {
+            ws2812b_strip_write_channels(s_ddp.config.strip, first, data, (uint16_t)pixels);
+            first += pixels;
+            count -= pixels;
+        }
+        if (count > 0) {
+            partial_len = len - pixels * bpp;
+            memcpy(partial, data + pixels * bpp, partial_len);
+        }
+    }
+    ws2812b_ddp_finish(&packet);
+    ws2812b_ddp_unlock_strip();
+}
+
+// 记录一个数据包从可读到处理完成的耗时，每秒更新包速率和平均耗时
+static void ws2812b_ddp_record_decode(int64_t start)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t elapsed = (uint32_t)(now - start);
+    
+    s_ddp.window_packets++;
+    s_ddp.window_decode_us += elapsed;
+    portENTER_CRITICAL(&s_ddp.lock);
+    if (elapsed > s_ddp.stats.max_decode_us) {
+        s_ddp.stats.max_decode_us = elapsed;
+    }
+    if (now - s_ddp.window_start >= 1000000) {
+        s_ddp.stats.packets_per_sec = (uint32_t)(s_ddp.window_packets * 1000000LL / (now - s_ddp.window_start));
+        s_ddp.stats.avg_decode_us = (uint32_t)(s_ddp.window_decode_us / s_ddp.window_packets);
+        s_ddp.window_start = now;
+        s_ddp.window_packets = 0;
+        s_ddp.window_decode_us = 0;
+    }
+    portEXIT_CRITICAL(&s_ddp.lock);
+}
+
+// 序号重新开始记录
+static void ws2812b_ddp_reset_sequence(void)
+{
+    s_ddp.last_sequence = 0;
+    s_ddp.push_sequence = 0;
+    s_ddp.seen = 0;
+    s_ddp.pending_dropped = 0;
+    s_ddp.pending_reordered = false;
+}
+
+// 数据源超时：序号重新开始记录，通知数据源停止
+static void ws2812b_ddp_handle_timeout(void)
+{
+    ws2812b_ddp_reset_sequence();
+    ws2812b_ddp_set_active(false);
+}
+
+// 按配置初始化接收状态（不涉及网络）
+static esp_err_t ws2812b_ddp_setup(const ws2812b_ddp_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(config && config->strip, ESP_ERR_INVALID_ARG, TAG, "参数为空");
+    
+    s_ddp.config = *config;
+    s_ddp.bytes_per_pixel = ws2812b_strip_get_bytes_per_pixel(config->strip);
+    ws2812b_ddp_reset_sequence();
+    s_ddp.active = false;
+    s_ddp.window_start = esp_timer_get_time();
+    s_ddp.window_packets = 0;
+    s_ddp.window_decode_us = 0;
+    memset(&s_ddp.stats, 0, sizeof(s_ddp.stats));
+    
+    return ESP_OK;
+}
+
+// 套接字路径：select等待可读，recv把数据包从pbuf拷贝到接收缓冲区后解析
+static void ws2812b_ddp_receive_socket(void)
+{
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(s_ddp.socket, &fds);
+    
+    struct timeval timeout = {
+        .tv_sec = WS2812B_DDP_TIMEOUT_MS / 1000,
+        .tv_usec = (WS2812B_DDP_TIMEOUT_MS % 1000) * 1000,
+    };
+    int ready = select(s_ddp.socket + 1, &fds, NULL, NULL, s_ddp.active ? &timeout : NULL);
+    if (!s_ddp.running) {
+        return;
+    }
+    if (ready == 0) {
+        ws2812b_ddp_handle_timeout();
+        return;
+    }
+    if (ready < 0) {
+        ESP_LOGE(TAG, "select失败");
+        vTaskDelay(pdMS_TO_TICKS(100));
+        return;
+    }
+    
+    int64_t start = esp_timer_get_time();
+    int len = recv(s_ddp.socket, s_ddp.rx_buffer, sizeof(s_ddp.rx_buffer), 0);
+    if (len > 0) {
+        ws2812b_ddp_handle_packet(s_ddp.rx_buffer, len);
+        ws2812b_ddp_record_decode(start);
+    }
+}
+
+// raw API路径：等待tcpip线程转交的pbuf，NULL为停止信号
+static void ws2812b_ddp_receive_raw(void)
+{
+    struct pbuf *p = NULL;
+    TickType_t wait = s_ddp.active ? pdMS_TO_TICKS(WS2812B_DDP_TIMEOUT_MS) : portMAX_DELAY;
+    
+    if (xQueueReceive(s_ddp.rx_queue, &p, wait) != pdTRUE) {
+        ws2812b_ddp_handle_timeout();
+        return;
+    }
+    if (!p) {
+        return;
+    }
+    
+    int64_t start = esp_timer_get_time();
+    ws2812b_ddp_handle_pbuf(p);
+    pbuf_free(p);
+    ws2812b_ddp_record_decode(start);
+}
+
+// UDP接收回调（tcpip线程）：只把pbuf交给接收任务，解析和写灯带都在接收任务中进行，灯带只有一个写入者
+static void ws2812b_ddp_raw_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+    if (xQueueSend(s_ddp.rx_queue, &p, 0) != pdTRUE) {
+        pbuf_free(p);
+        portENTER_CRITICAL(&s_ddp.lock);
+        s_ddp.stats.queue_overflows++;
+        portEXIT_CRITICAL(&s_ddp.lock);
+    }
+}
+
+// raw API的控制块只能在tcpip线程中创建和删除，通过esp_netif_tcpip_exec()在tcpip线程中同步执行
+static esp_err_t ws2812b_ddp_raw_bind(void *ctx)
+{
+    struct udp_pcb *pcb = udp_new();
+    if (!pcb) {
+        return ESP_ERR_NO_MEM;
+    }
+    err_t err = udp_bind(pcb, IP_ADDR_ANY, WS2812B_DDP_PORT);
+    if (err != ERR_OK) {
+        udp_remove(pcb);
+        return ESP_FAIL;
+    }
+    udp_recv(pcb, ws2812b_ddp_raw_recv, NULL);
+    s_ddp.pcb = pcb;
+    return ESP_OK;
+}
+
+static esp_err_t ws2812b_ddp_raw_remove(void *ctx)
+{
+    udp_remove(s_ddp.pcb);
+    s_ddp.pcb = NULL;
+    return ESP_OK;
+}
+
+// 接收任务：阻塞等待数据包，没有数据时不唤醒；正在接收时以WS2812B_DDP_TIMEOUT_MS检测数据源停止
+static void ws2812b_ddp_task(void *arg)
+{
+    ESP_LOGI(TAG, "接收任务启动，端口%d，%d个LED，%s", WS2812B_DDP_PORT,
+             ws2812b_strip_get_led_count(s_ddp.config.strip), s_ddp.config.use_socket ? "套接字" : "raw API");
+    
+    while (s_ddp.running) {
+        if (s_ddp.config.use_socket) {
+            ws2812b_ddp_receive_socket();
+        } else {
+            ws2812b_ddp_receive_raw();
+        }
+    }
+    
+    if (s_ddp.config.use_socket) {
+        close(s_ddp.socket);
+        s_ddp.socket = -1;
+    } else {
+        // 控制块已删除，释放队列中尚未处理的pbuf
+        struct pbuf *p;
+        while (xQueueReceive(s_ddp.rx_queue, &p, 0) == pdTRUE) {
+            if (p) {
+                pbuf_free(p);
+            }
+        }
+    }
+    ESP_LOGI(TAG, "接收任务退出");
+    
+    xTaskNotifyGive(s_ddp.stop_waiter);
+    vTaskDelete(NULL);
+}
+
+// 打开套接字并绑定UDP端口4048
+static esp_err_t ws2812b_ddp_open_socket(void)
+{
+    s_ddp.socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ESP_RETURN_ON_FALSE(s_ddp.socket >= 0, ESP_FAIL, TAG, "创建套接字失败");
+    
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(WS2812B_DDP_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(s_ddp.socket, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(s_ddp.socket);
+        s_ddp.socket = -1;
+        ESP_LOGE(TAG, "绑定端口%d失败", WS2812B_DDP_PORT);
+        return ESP_FAIL;
+    }
+    
+    return ESP_OK;
+}
+
+// 创建raw API控制块，接收回调把pbuf放入队列
+static esp_err_t ws2812b_ddp_open_raw(void)
+{
+    if (!s_ddp.rx_queue) {
+        s_ddp.rx_queue = xQueueCreate(WS2812B_DDP_RX_QUEUE_LEN, sizeof(struct pbuf *));
+        ESP_RETURN_ON_FALSE(s_ddp.rx_queue, ESP_ERR_NO_MEM, TAG, "创建接收队列失败");
+    }
+    
+    ESP_RETURN_ON_ERROR(esp_netif_tcpip_exec(ws2812b_ddp_raw_bind, NULL), TAG, "绑定端口%d失败", WS2812B_DDP_PORT);
+    
+    return ESP_OK;
+}
+
+// 启动接收器：打开UDP端口4048，在独立任务中接收
+esp_err_t ws2812b_ddp_start(const ws2812b_ddp_config_t *config)
+{
+    esp_err_t ret = ESP_OK;
+    
+    ESP_RETURN_ON_FALSE(!s_ddp.running, ESP_ERR_INVALID_STATE, TAG, "接收器已在运行");
+    ESP_RETURN_ON_ERROR(ws2812b_ddp_setup(config), TAG, "接收配置无效");
+    ESP_RETURN_ON_ERROR(config->use_socket ? ws2812b_ddp_open_socket() : ws2812b_ddp_open_raw(), TAG,
+                        "打开DDP端口失败");
+    
+    s_ddp.running = true;
+    BaseType_t created = xTaskCreate(ws2812b_ddp_task, "ws2812b_ddp", WS2812B_DDP_TASK_STACK_SIZE,
+                                     NULL, WS2812B_DDP_TASK_PRIORITY, &s_ddp.task);
+    ESP_GOTO_ON_FALSE(created == pdPASS, ESP_ERR_NO_MEM, err, TAG, "创建接收任务失败");
+    
+    return ESP_OK;
+
+err:
+    s_ddp.running = false;
+    if (config->use_socket) {
+        close(s_ddp.socket);
+        s_ddp.socket = -1;
+    } else {
+        esp_netif_tcpip_exec(ws2812b_ddp_raw_remove, NULL);
+    }
+    return ret;
+}
+
+// 停止接收器并等待接收任务退出
+// 套接字路径向自己的端口发送一个空包唤醒接收任务；raw API路径删除控制块后向队列放入停止信号
+esp_err_t ws2812b_ddp_stop(void)
+{
+    ESP_RETURN_ON_FALSE(s_ddp.running, ESP_ERR_INVALID_STATE, TAG, "接收器未运行");
+    
+    s_ddp.stop_waiter = xTaskGetCurrentTaskHandle();
+    
+    if (s_ddp.config.use_socket) {
+        s_ddp.running = false;
+        int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (sock >= 0) {
+            struct sockaddr_in addr = {
+                .sin_family = AF_INET,
+                .sin_port = htons(WS2812B_DDP_PORT),
+                .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+            };
+            sendto(sock, "", 1, 0, (struct sockaddr *)&addr, sizeof(addr));
+            close(sock);
+        }
+    } else {
+        esp_netif_tcpip_exec(ws2812b_ddp_raw_remove, NULL);
+        s_ddp.running = false;
+        struct pbuf *stop = NULL;
+        xQueueSend(s_ddp.rx_queue, &stop, portMAX_DELAY);
+    }
+    
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    s_ddp.task = NULL;
+    
+    return ESP_OK;
+}
+
+// 获取接收统计
+esp_err_t ws2812b_ddp_get_stats(ws2812b_ddp_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "参数为空");
+    
+    portENTER_CRITICAL(&s_ddp.lock);
+    *stats = s_ddp.stats;
+    portEXIT_CRITICAL(&s_ddp.lock);
+    
+    return ESP_OK;
+}
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+// 构造DDP数据包，返回长度
+static size_t ws2812b_ddp_build(uint8_t *buf, uint8_t flags, uint8_t sequence, uint32_t offset,
+                                const uint8_t *data, uint16_t length)
+{
+    size_t header_len = (flags & DDP_FLAG_TIMECODE) ? DDP_HEADER_LEN_TIMECODE : DDP_HEADER_LEN;
+    memset(buf, 0, header_len);
+    buf[DDP_FLAGS_OFFSET] = DDP_FLAG_VERSION_1 | flags;
+    buf[DDP_SEQUENCE_OFFSET] = sequence;
+    buf[DDP_TYPE_OFFSET] = 0x0B;    // 8位RGB
+    buf[DDP_ID_OFFSET] = DDP_ID_DEFAULT;
+    buf[DDP_DATA_OFFSET_OFFSET] = offset >> 24;
+    buf[DDP_DATA_OFFSET_OFFSET + 1] = (offset >> 16) & 0xFF;
+    buf[DDP_DATA_OFFSET_OFFSET + 2] = (offset >> 8) & 0xFF;
+    buf[DDP_DATA_OFFSET_OFFSET + 3] = offset & 0xFF;
+    buf[DDP_LENGTH_OFFSET] = length >> 8;
+    buf[DDP_LENGTH_OFFSET + 1] = length & 0xFF;
+    memcpy(buf + header_len, data, length);
+    return header_len + length;
+}
+
+// 序号1-15循环
+static inline uint8_t ws2812b_ddp_next_sequence(uint8_t sequence)
+{
+    return sequence % 15 + 1;
+}
+
+// 生成测试数据，seed区分不同的帧和包
+static void ws2812b_ddp_test_fill(uint8_t *data, uint16_t length, uint32_t seed)
+{
+    for (uint16_t i = 0; i < length; i++) {
+        data[i] = (uint8_t)(i * 7 + seed + 1);
+    }
+}
+
+// 接收处理自检：不经过网络，把构造的数据包直接送入处理函数（接收器运行时不能调用）
+// 会改写灯带内容
+bool ws2812b_ddp_test_receiver(ws2812b_strip_t *strip)
+{
+    static uint8_t packet[WS2812B_DDP_RX_BUFFER_SIZE];
+    static uint8_t payload[WS2812B_DDP_RX_BUFFER_SIZE - DDP_HEADER_LEN_TIMECODE];
+    ws2812b_ddp_packet_t parsed;
+    bool passed = true;
+    
+    if (s_ddp.running) {
+        ESP_LOGE(TAG, "接收器运行中，无法测试");
+        return false;
+    }
+    
+    ws2812b_ddp_config_t config = {
+        .strip = strip,
+    };
+    if (ws2812b_ddp_setup(&config) != ESP_OK) {
+        return false;
+    }
+    
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 7);
+    }
+    
+    // 解析：数据指针直接指向包内，带时间码时数据后移4字节
+    size_t len = ws2812b_ddp_build(packet, DDP_FLAG_PUSH, 5, 0x123456, payload, 300);
+    if (ws2812b_ddp_parse(packet, len, &parsed) != ESP_OK || !parsed.push || parsed.sequence != 5 ||
+        parsed.offset != 0x123456 || parsed.length != 300 || parsed.data != packet + DDP_HEADER_LEN) {
+        ESP_LOGE(TAG, "DDP解析错误");
+        passed = false;
+    }
+    len = ws2812b_ddp_build(packet, DDP_FLAG_TIMECODE, 9, 0, payload, 30);
+    if (ws2812b_ddp_parse(packet, len, &parsed) != ESP_OK || parsed.push || parsed.sequence != 9 ||
+        parsed.length != 30 || parsed.data != packet + DDP_HEADER_LEN_TIMECODE) {
+        ESP_LOGE(TAG, "DDP时间码包解析错误");
+        passed = false;
+    }
+    
+    // 格式错误：截断、版本号不对
+    bool truncated_ok = ws2812b_ddp_parse(packet, len - 1, &parsed) == ESP_OK;
+    packet[DDP_FLAGS_OFFSET] = 0x80;
+    if (truncated_ok || ws2812b_ddp_parse(packet, len, &parsed) == ESP_OK) {
+        ESP_LOGE(TAG, "未拒绝格式错误的数据包");
+        passed = false;
+    }
+    
+    // 每帧按整像素拆成最多8个包（RGB每包最多480、RGBW最多364个像素，不超过接收缓冲区），
+    // 序号按包的顺序递增，最后一个包带PUSH；除PUSH外按序号倒序送入，序号落后的包属于尚未提交的帧，应照常写入
+    // PUSH后把预期内容直接写入灯带再刷新，每个像素都已写入时内容不变被跳过（不适用于抖动模式的灯带）
+    uint8_t bpp = s_ddp.bytes_per_pixel;
+    uint32_t frame_bytes = (uint32_t)ws2812b_strip_get_led_count(strip) * bpp;
+    uint32_t max_pixels = (WS2812B_DDP_RX_BUFFER_SIZE - DDP_HEADER_LEN_TIMECODE) / bpp;
+    uint32_t chunk_pixels = (ws2812b_strip_get_led_count(strip) + 7) / 8;
+    if (chunk_pixels > max_pixels) {
+        chunk_pixels = max_pixels;
+    }
+    if (chunk_pixels > 480) {
+        chunk_pixels = 480;
+    }
+    uint32_t chunk = chunk_pixels * bpp;
+    uint32_t chunks = (frame_bytes + chunk - 1) / chunk;
+    if (chunks > 8) {
+        ESP_LOGW(TAG, "LED数量过多，只测试前 %lu 个像素", (unsigned long)(8 * chunk_pixels));
+        chunks = 8;
+    }
+    uint8_t seq = 1;
+    uint32_t packets = 0;
+    uint32_t missing_frames = 0;
+    for (uint32_t frame = 0; frame < 3; frame++) {
+        uint8_t base = seq;
+        ws2812b_strip_clear(strip);
+        for (uint32_t i = 0; i < chunks; i++) {
+            uint32_t c = (i + 1 < chunks) ? chunks - 2 - i : chunks - 1;
+            uint32_t offset = c * chunk;
+            uint16_t length = (uint16_t)(frame_bytes - offset < chunk ? frame_bytes - offset : chunk);
+            uint8_t chunk_seq = base;
+            for (uint32_t k = 0; k < c; k++) {
+                chunk_seq = ws2812b_ddp_next_sequence(chunk_seq);
+            }
+            ws2812b_ddp_test_fill(payload, length, frame * 31 + c * 13);
+            len = ws2812b_ddp_build(packet, c + 1 == chunks ? DDP_FLAG_PUSH : 0, chunk_seq, offset, payload, length);
+            ws2812b_ddp_handle_packet(packet, len);
+            packets++;
+            seq = ws2812b_ddp_next_sequence(chunk_seq);
+        }
+        
+#if WS2812B_SKIP_UNCHANGED
+        ws2812b_strip_stats_t before, after;
+        ws2812b_strip_get_stats(strip, &before);
+        for (uint32_t c = 0; c < chunks; c++) {
+            uint32_t offset = c * chunk;
+            uint16_t length = (uint16_t)(frame_bytes - offset < chunk ? frame_bytes - offset : chunk);
+            ws2812b_ddp_test_fill(payload, length, frame * 31 + c * 13);
+            ws2812b_strip_write_channels(strip, offset / bpp, payload, length / bpp);
+        }
+        ws2812b_strip_refresh(strip);
+        ws2812b_strip_get_stats(strip, &after);
+        if (after.frames_skipped != before.frames_skipped + 1) {
+            missing_frames++;
+        }
+#endif
+    }
+    if (missing_frames) {
+        ESP_LOGE(TAG, "%lu 帧有像素未写入", (unsigned long)missing_frames);
+        passed = false;
+    }
+    
+    // 丢包：跳过2个序号；迟到：PUSH之后到达的更早序号属于已经提交的帧，丢弃
+    uint8_t late_seq = seq;
+    seq = ws2812b_ddp_next_sequence(ws2812b_ddp_next_sequence(seq));
+    len = ws2812b_ddp_build(packet, DDP_FLAG_PUSH, seq, 0, payload, 3 * bpp);
+    ws2812b_ddp_handle_packet(packet, len);
+    len = ws2812b_ddp_build(packet, DDP_FLAG_PUSH, late_seq, 0, payload, 3 * bpp);
+    ws2812b_ddp_handle_packet(packet, len);
+    
+    // 偏移未按像素对齐或超出灯带：丢弃
+    len = ws2812b_ddp_build(packet, 0, 0, 1, payload, bpp);
+    ws2812b_ddp_handle_packet(packet, len);
+    len = ws2812b_ddp_build(packet, 0, 0, frame_bytes, payload, bpp);
+    ws2812b_ddp_handle_packet(packet, len);
+    ws2812b_ddp_handle_timeout();
+    
+    ws2812b_ddp_stats_t stats = s_ddp.stats;
+    uint32_t reordered = chunks > 2 ? 3 * (chunks - 2) : 0;
+    ESP_LOGI(TAG, "包 %lu, 丢包 %lu, 乱序 %lu, 迟到 %lu, 无效 %lu, 帧 %lu", (unsigned long)stats.packets,
+             (unsigned long)stats.dropped_packets, (unsigned long)stats.reordered_packets,
+             (unsigned long)stats.late_packets, (unsigned long)stats.invalid_packets, (unsigned long)stats.frames);
+    if (stats.packets != packets + 1 || stats.dropped_packets != 2 || stats.reordered_packets != reordered ||
+        stats.late_packets != 1 || stats.invalid_packets != 2 || stats.frames != 4) {
+        ESP_LOGE(TAG, "接收统计与预期不符");
+        passed = false;
+    }
+    
+    ESP_LOGI(TAG, "DDP接收自检%s", passed ? "通过" : "失败");
+    ws2812b_strip_clear(strip);
+    ws2812b_strip_refresh(strip);
+    return passed;
+}
+
+// pbuf链解码测试：一个最多480像素（不超过接收缓冲区）的数据包放在两个pbuf组成的链中（分界处切开一个像素），
+// 分别先整包拷贝到连续缓冲区再解析、直接从pbuf链解码，比较写入的像素并打印每包耗时
+// 只测量省掉的整包拷贝，不包含套接字的邮箱转发、select()/recv()等开销，不能代替套接字与raw API的实测对比
+// 不带PUSH，只测解码和写缓冲区；用跳过未变化帧检查两种解码写入的像素一致，不适用于抖动模式的灯带
+// 会改写灯带内容
+bool ws2812b_ddp_test_pbuf_decode(ws2812b_strip_t *strip, uint32_t iterations)
+{
+    static uint8_t payload[WS2812B_DDP_RX_BUFFER_SIZE - DDP_HEADER_LEN];
+    bool passed = true;
+    
+    if (s_ddp.running) {
+        ESP_LOGE(TAG, "接收器运行中，无法测试");
+        return false;
+    }
+    
+    ws2812b_ddp_config_t config = {
+        .strip = strip,
+    };
+    if (ws2812b_ddp_setup(&config) != ESP_OK || iterations == 0) {
+        return false;
+    }
+    
+    // 整包要放进接收缓冲区：RGB最多480个像素，RGBW最多365个
+    uint8_t bpp = s_ddp.bytes_per_pixel;
+    uint16_t pixels = ws2812b_strip_get_led_count(strip) < 480 ? ws2812b_strip_get_led_count(strip) : 480;
+    if (pixels > sizeof(payload) / bpp) {
+        pixels = sizeof(payload) / bpp;
+    }
+    uint16_t length = pixels * bpp;
+    for (uint16_t i = 0; i < length; i++) {
+        payload[i] = (uint8_t)(i * 7 + 1);
+    }
+    
+    // 构造数据包并拆成两个pbuf
+    size_t len = ws2812b_ddp_build(s_ddp.rx_buffer, 0, 0, 0, payload, length);
+    size_t split = DDP_HEADER_LEN + (pixels / 2) * bpp + 1;
+    struct pbuf *chain = pbuf_alloc(PBUF_RAW, split, PBUF_RAM);
+    struct pbuf *tail = pbuf_alloc(PBUF_RAW, len - split, PBUF_RAM);
+    if (!chain || !tail) {
+        ESP_LOGE(TAG, "分配pbuf失败");
+        if (chain) {
+            pbuf_free(chain);
+        }
+        if (tail) {
+            pbuf_free(tail);
+        }
+        return false;
+    }
+    memcpy(chain->payload, s_ddp.rx_buffer, split);
+    memcpy(tail->payload, s_ddp.rx_buffer + split, len - split);
+    pbuf_cat(chain, tail);
+    
+    ws2812b_strip_clear(strip);
+    ws2812b_strip_refresh(strip);
+    
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        pbuf_copy_partial(chain, s_ddp.rx_buffer, chain->tot_len, 0);
+        ws2812b_ddp_handle_packet(s_ddp.rx_buffer, chain->tot_len);
+    }
+    int64_t copy_us = esp_timer_get_time() - start;
+    ws2812b_strip_refresh(strip);
+    
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        ws2812b_ddp_handle_pbuf(chain);
+    }
+    int64_t chain_us = esp_timer_get_time() - start;
+    pbuf_free(chain);
+    
+    ESP_LOGI(TAG, "每包%d字节: 拷贝后解码 %lld ns/包, 从pbuf链解码 %lld ns/包", length,
+             (long long)(copy_us * 1000 / iterations), (long long)(chain_us * 1000 / iterations));
+    
+#if WS2812B_SKIP_UNCHANGED
+    // 从pbuf链解码写入的像素与拷贝后解码相同时，这次刷新内容不变会被跳过
+    ws2812b_strip_stats_t before, after;
+    ws2812b_strip_get_stats(strip, &before);
+    ws2812b_strip_refresh(strip);
+    ws2812b_strip_get_stats(strip, &after);
+    if (after.frames_skipped != before.frames_skipped + 1) {
+        ESP_LOGE(TAG, "两种解码写入的像素不一致");
+        passed = false;
+    }
+#endif
+    if (s_ddp.stats.packets != iterations * 2 || s_ddp.stats.invalid_packets != 0) {
+        ESP_LOGE(TAG, "解码统计与预期不符");
+        passed = false;
+    }
+    
+    ESP_LOGI(TAG, "DDP pbuf链解码测试%s", passed ? "通过" : "失败");
+    ws2812b_strip_clear(strip);
+    ws2812b_strip_refresh(strip);
+    return passed;
+}
@@ -0,0 +1,77 @@
+#ifndef WS2812B_DDP_H
+#define WS2812B_DDP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "ws2812b_driver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// DDP（Distributed Display Protocol）接收：UDP端口4048
+// 每个数据包带有字节偏移，直接写入灯带后台缓冲区的对应位置；收到带PUSH标志的包时整帧提交显示
+// 一帧拆成多个包时，PUSH之前屏幕不变，大帧也能整体切换
+
+// 解析结果：data指向原始数据包内部，不拷贝
+typedef struct {
+    uint8_t flags;                      // 标志字节（版本、时间码、查询、PUSH等）
+    uint8_t sequence;                   // 序号（1-15），0表示发送方不使用序号
+    uint8_t data_type;                  // 数据类型（如0x0B为8位RGB），不使用
+    uint8_t destination;                // 目标设备ID（1为默认输出，255为全部）
+    uint32_t offset;                    // 数据在帧中的字节偏移
+    bool push;                          // 是否在写入后提交显示
+    const uint8_t *data;                // 像素数据，按R、G、B（RGBW灯带再加W）排列
+    uint16_t length;                    // 数据字节数
+} ws2812b_ddp_packet_t;
+
+// 数据源状态变化回调（在接收任务中调用），含义同ws2812b_dmx_source_cb_t
+typedef void (*ws2812b_ddp_source_cb_t)(bool active, void *user_ctx);
+
+// 接收配置
+typedef struct {
+    ws2812b_strip_t *strip;             // 输出灯带
+    bool use_socket;                    // true：通过BSD套接字接收，false：lwIP raw API，从pbuf直接解码
+    ws2812b_ddp_source_cb_t on_source;  // 可选：数据源状态变化回调
+    void *user_ctx;
+    SemaphoreHandle_t strip_lock;       // 可选：含义同ws2812b_dmx_config_t.strip_lock
+} ws2812b_ddp_config_t;
+
+// 接收统计
+typedef struct {
+    uint32_t packets;                   // 已写入的数据包
+    uint32_t packets_per_sec;           // 最近一个统计周期的包速率
+    uint32_t frames;                    // 已提交显示的帧（收到PUSH的次数）
+    uint32_t dropped_packets;           // 按序号推算丢失的数据包
+    uint32_t reordered_packets;         // 乱序到达但属于尚未提交的帧、照常写入的数据包
+    uint32_t late_packets;              // 属于已经提交（PUSH）的帧、迟到而丢弃的数据包
+    uint32_t invalid_packets;           // 格式错误、偏移未按像素对齐或超出灯带的数据包
+    uint32_t queue_overflows;           // raw API路径：接收任务来不及处理而丢弃的数据包
+    uint32_t avg_decode_us;             // 最近一个统计周期每包的平均处理耗时（从可读到写入灯带，含套接字拷贝）
+    uint32_t max_decode_us;             // 每包最大处理耗时
+} ws2812b_ddp_stats_t;
+
+// 解析一个UDP负载，不依赖网络和灯带，可单独测试
+esp_err_t ws2812b_ddp_parse(const uint8_t *buf, size_t len, ws2812b_ddp_packet_t *packet);
+
+// 接收器接口（全局唯一）：通常在获取IP后启动
+esp_err_t ws2812b_ddp_start(const ws2812b_ddp_config_t *config);
+esp_err_t ws2812b_ddp_stop(void);
+esp_err_t ws2812b_ddp_get_stats(ws2812b_ddp_stats_t *stats);
+
+// 测试函数：把一帧拆成多个包按打乱的序号送入接收处理，检查每个像素都写入，并模拟丢包和迟到，检查统计
+bool ws2812b_ddp_test_receiver(ws2812b_strip_t *strip);
+
+// 测试函数：同一个跨两个pbuf的数据包分别先整包拷贝再解析、直接从pbuf链解码，
+// 检查两者写入的像素一致并打印每包耗时（只包含拷贝的差别，不是套接字与raw API的对比）
+bool ws2812b_ddp_test_pbuf_decode(ws2812b_strip_t *strip, uint32_t iterations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS2812B_DDP_H
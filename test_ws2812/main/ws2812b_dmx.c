@@ -0,0 +1,447 @@
+#include "ws2812b_dmx.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include <string.h>
+
+static const char *TAG = "WS2812B_DMX";
+
+// UDP端口
+#define WS2812B_DMX_E131_PORT       5568
+#define WS2812B_DMX_ARTNET_PORT     6454
+
+// 序号落后不超过该值时视为乱序包丢弃，更大的落后视为发送方重启（E1.31规定为20）
+#define WS2812B_DMX_SEQUENCE_WINDOW 20
+
+// 接收器（全局唯一）
+static struct {
+    ws2812b_dmx_config_t config;
+    uint16_t pixels_per_universe;                       // 每个宇宙的LED数（512 / 每像素字节数）
+    uint16_t universe_count;                            // 灯带占用的宇宙数
+    uint32_t complete_mask;                             // 所有宇宙都收到时的掩码
+    uint32_t received_mask;                             // 本帧已收到的宇宙
+    uint32_t sequence_valid;                            // 已记录序号的宇宙
+    uint8_t last_sequence[WS2812B_DMX_MAX_UNIVERSES];   // 各宇宙上一个包的序号
+    bool active;                                        // 是否正在收到数据
+    int64_t window_start;                               // 包速率统计周期起点
+    uint32_t window_packets;
+    ws2812b_dmx_stats_t stats;
+    int sockets[2];                                     // E1.31和Art-Net的UDP套接字，-1表示未启用
+    TaskHandle_t task;
+    TaskHandle_t stop_waiter;                           // 等待接收任务退出的任务
+    volatile bool running;
+    portMUX_TYPE lock;
+    uint8_t rx_buffer[WS2812B_DMX_MAX_PACKET_SIZE];      // 接收缓冲区，解析后直接从这里写入灯带
+} s_dmx = {
+    .sockets = {-1, -1},
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+// 数据源状态变化
+static void ws2812b_dmx_set_active(bool active)
+{
+    if (s_dmx.active == active) {
+        return;
+    }
+    s_dmx.active = active;
+    ESP_LOGI(TAG, "数据源%s", active ? "开始发送" : "已停止");
+    if (s_dmx.config.on_source) {
+        s_dmx.config.on_source(active, s_dmx.config.user_ctx);
+    }
+}
+
+// 灯带互斥锁（未配置时不加锁）
+static inline void ws2812b_dmx_lock_strip(void)
+{
+    if (s_dmx.config.strip_lock) {
+        xSemaphoreTake(s_dmx.config.strip_lock, portMAX_DELAY);
+    }
+}
+
+static inline void ws2812b_dmx_unlock_strip(void)
+{
+    if (s_dmx.config.strip_lock) {
+        xSemaphoreGive(s_dmx.config.strip_lock);
+    }
+}
+
+// 提交当前帧显示
+static void ws2812b_dmx_present(bool complete)
+{
+    ws2812b_strip_refresh_async(s_dmx.config.strip);
+    s_dmx.received_mask = 0;
+    
+    portENTER_CRITICAL(&s_dmx.lock);
+    s_dmx.stats.frames++;
+    if (!complete) {
+        s_dmx.stats.partial_frames++;
+    }
+    portEXIT_CRITICAL(&s_dmx.lock);
+}
+
+// 处理一个数据包：检查序号，把通道数据写入灯带，收齐所有宇宙后提交显示
+static void ws2812b_dmx_handle_packet(const uint8_t *buf, size_t len)
+{
+    ws2812b_dmx_packet_t packet;
+    int index = -1;
+    
+    if (ws2812b_dmx_parse(buf, len, &packet) == ESP_OK && (packet.protocol & s_dmx.config.protocols)) {
+        index = ws2812b_dmx_universe_index(packet.universe, s_dmx.config.start_universe, s_dmx.universe_count);
+    }
+    if (index < 0) {
+        portENTER_CRITICAL(&s_dmx.lock);
+        s_dmx.stats.invalid_packets++;
+        portEXIT_CRITICAL(&s_dmx.lock);
+        return;
+    }
+    
+    if (packet.preview) {
+        return;
+    }
+    if (packet.terminated) {
+        ws2812b_dmx_set_active(false);
+        return;
+    }
+    
+    uint32_t bit = 1UL << index;
+    
+    // 序号检查：落后窗口内的包是乱序到达的旧数据，直接丢弃；跳过的序号计为丢包
+    uint32_t dropped = 0;
+    bool sequenced = ws2812b_dmx_has_sequence(&packet);
+    if (sequenced && (s_dmx.sequence_valid & bit)) {
+        int diff = ws2812b_dmx_sequence_diff(packet.protocol, packet.sequence, s_dmx.last_sequence[index]);
+        if (diff <= 0 && diff > -WS2812B_DMX_SEQUENCE_WINDOW) {
+            portENTER_CRITICAL(&s_dmx.lock);
+            s_dmx.stats.late_packets++;
+            portEXIT_CRITICAL(&s_dmx.lock);
+            return;
+        }
+        if (diff > 1) {
+            dropped = diff - 1;
+        }
+    }
+    if (sequenced) {
+        s_dmx.last_sequence[index] = packet.sequence;
+        s_dmx.sequence_valid |= bit;
+    }
+    
+    ws2812b_dmx_set_active(true);
+    
+    // 同一宇宙在本帧收齐之前再次到达，说明其他宇宙的包丢失了，先提交已有的数据
+    ws2812b_dmx_lock_strip();
+    if (s_dmx.received_mask & bit) {
+        ws2812b_dmx_present(false);
+    }
+    
+    // 从接收缓冲区直接写入后台缓冲区，不经过中间数组
+    uint16_t first = index * s_dmx.pixels_per_universe;
+    uint16_t count = packet.length / ws2812b_strip_get_bytes_per_pixel(s_dmx.config.strip);
+    uint16_t led_count = ws2812b_strip_get_led_count(s_dmx.config.strip);
+    if (count > led_count - first) {
+        count = led_count - first;
+    }
+    ws2812b_strip_write_channels(s_dmx.config.strip, first, packet.data, count);
+    
+    s_dmx.received_mask |= bit;
+    if (s_dmx.received_mask == s_dmx.complete_mask) {
+        ws2812b_dmx_present(true);
+    }
+    ws2812b_dmx_unlock_strip();
+    
+    // 统计包速率（每秒更新一次）
+    int64_t now = esp_timer_get_time();
+    s_dmx.window_packets++;
+    portENTER_CRITICAL(&s_dmx.lock);
+    s_dmx.stats.packets++;
+    s_dmx.stats.dropped_packets += dropped;
+    if (now - s_dmx.window_start >= 1000000) {
+        s_dmx.stats.packets_per_sec = (uint32_t)(s_dmx.window_packets * 1000000LL / (now - s_dmx.window_start));
+        s_dmx.window_start = now;
+        s_dmx.window_packets = 0;
+    }
+    portEXIT_CRITICAL(&s_dmx.lock);
+}
+
+// 数据源超时：提交未收齐的帧，通知数据源停止
+static void ws2812b_dmx_handle_timeout(void)
+{
+    if (s_dmx.received_mask) {
+        ws2812b_dmx_lock_strip();
+        ws2812b_dmx_present(false);
+        ws2812b_dmx_unlock_strip();
+    }
+    s_dmx.sequence_valid = 0;
+    ws2812b_dmx_set_active(false);
+}
+
+// 按配置初始化接收状态（不涉及网络）
+static esp_err_t ws2812b_dmx_setup(const ws2812b_dmx_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(config && config->strip, ESP_ERR_INVALID_ARG, TAG, "参数为空");
+    ESP_RETURN_ON_FALSE(config->protocols, ESP_ERR_INVALID_ARG, TAG, "未启用任何协议");
+    
+    uint16_t pixels_per_universe = WS2812B_DMX_CHANNELS / ws2812b_strip_get_bytes_per_pixel(config->strip);
+    uint16_t led_count = ws2812b_strip_get_led_count(config->strip);
+    uint16_t universe_count = (led_count + pixels_per_universe - 1) / pixels_per_universe;
+    ESP_RETURN_ON_FALSE(universe_count <= WS2812B_DMX_MAX_UNIVERSES, ESP_ERR_INVALID_SIZE, TAG,
+                        "灯带需要%d个宇宙，超过上限%d", universe_count, WS2812B_DMX_MAX_UNIVERSES);
+    ESP_RETURN_ON_FALSE((uint32_t)config->start_universe + universe_count <= 0x10000, ESP_ERR_INVALID_ARG, TAG,
+                        "起始宇宙超出范围: %d", config->start_universe);
+    
+    s_dmx.config = *config;
+    s_dmx.pixels_per_universe = pixels_per_universe;
+    s_dmx.universe_count = universe_count;
+    s_dmx.complete_mask = universe_count == 32 ? UINT32_MAX : (1UL << universe_count) - 1;
+    s_dmx.received_mask = 0;
+    s_dmx.sequence_valid = 0;
+    s_dmx.active = false;
+    s_dmx.window_start = esp_timer_get_time();
+    s_dmx.window_packets = 0;
+    memset(&s_dmx.stats, 0, sizeof(s_dmx.stats));
+    
+    return ESP_OK;
+}
+
+// 创建并绑定UDP套接字
+static int ws2812b_dmx_open_socket(uint16_t port)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "创建套接字失败");
+        return -1;
+    }
+    
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        ESP_LOGE(TAG, "绑定端口%d失败", port);
+        close(sock);
+        return -1;
+    }
+    
+    return sock;
+}
+
+// E1.31组播：每个宇宙对应组播地址239.255.<高字节>.<低字节>
+static void ws2812b_dmx_join_multicast(int sock)
+{
+    for (uint16_t i = 0; i < s_dmx.universe_count; i++) {
+        uint16_t universe = s_dmx.config.start_universe + i;
+        struct ip_mreq mreq = {
+            .imr_multiaddr.s_addr = htonl(0xEFFF0000 | universe),
+            .imr_interface.s_addr = htonl(INADDR_ANY),
+        };
+        if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+            ESP_LOGW(TAG, "加入宇宙%d的组播组失败，只能接收单播", universe);
+        }
+    }
+}
+
+// 接收任务：阻塞等待数据包，没有数据时不唤醒；正在接收时以WS2812B_DMX_TIMEOUT_MS检测数据源停止
+static void ws2812b_dmx_task(void *arg)
+{
+    ESP_LOGI(TAG, "接收任务启动，宇宙 %d-%d，每宇宙%d个LED", s_dmx.config.start_universe,
+             s_dmx.config.start_universe + s_dmx.universe_count - 1, s_dmx.pixels_per_universe);
+    
+    while (s_dmx.running) {
+        fd_set fds;
+        int max_fd = -1;
+        FD_ZERO(&fds);
+        for (int i = 0; i < 2; i++) {
+            if (s_dmx.sockets[i] >= 0) {
+                FD_SET(s_dmx.sockets[i], &fds);
+                if (s_dmx.sockets[i] > max_fd) {
+                    max_fd = s_dmx.sockets[i];
+                }
+            }
+        }
+        
+        struct timeval timeout = {
+            .tv_sec = WS2812B_DMX_TIMEOUT_MS / 1000,
+            .tv_usec = (WS2812B_DMX_TIMEOUT_MS % 1000) * 1000,
+        };
+        int ready = select(max_fd + 1, &fds, NULL, NULL, s_dmx.active ? &timeout : NULL);
+        if (!s_dmx.running) {
+            break;
+        }
+        if (ready == 0) {
+            ws2812b_dmx_handle_timeout();
+            continue;
+        }
+        if (ready < 0) {
+            ESP_LOGE(TAG, "select失败");
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+        
+        for (int i = 0; i < 2; i++) {
+            if (s_dmx.sockets[i] >= 0 && FD_ISSET(s_dmx.sockets[i], &fds)) {
+                int len = recv(s_dmx.sockets[i], s_dmx.rx_buffer, sizeof(s_dmx.rx_buffer), 0);
+                if (len > 0) {
+                    ws2812b_dmx_handle_packet(s_dmx.rx_buffer, len);
+                }
+            }
+        }
+    }
+    
+    for (int i = 0; i < 2; i++) {
+        if (s_dmx.sockets[i] >= 0) {
+            close(s_dmx.sockets[i]);
+            s_dmx.sockets[i] = -1;
+        }
+    }
+    ESP_LOGI(TAG, "接收任务退出");
+    
+    xTaskNotifyGive(s_dmx.stop_waiter);
+    vTaskDelete(NULL);
+}
+
+// 启动接收器：打开所启用协议的UDP端口，在独立任务中接收
+esp_err_t ws2812b_dmx_start(const ws2812b_dmx_config_t *config)
+{
+    esp_err_t ret = ESP_OK;
+    
+    ESP_RETURN_ON_FALSE(!s_dmx.running, ESP_ERR_INVALID_STATE, TAG, "接收器已在运行");
+    ESP_RETURN_ON_ERROR(ws2812b_dmx_setup(config), TAG, "接收配置无效");
+    
+    if (config->protocols & WS2812B_DMX_PROTO_E131) {
+        s_dmx.sockets[0] = ws2812b_dmx_open_socket(WS2812B_DMX_E131_PORT);
+        ESP_GOTO_ON_FALSE(s_dmx.sockets[0] >= 0, ESP_FAIL, err, TAG, "打开E1.31端口失败");
+        ws2812b_dmx_join_multicast(s_dmx.sockets[0]);
+    }
+    if (config->protocols & WS2812B_DMX_PROTO_ARTNET) {
+        s_dmx.sockets[1] = ws2812b_dmx_open_socket(WS2812B_DMX_ARTNET_PORT);
+        ESP_GOTO_ON_FALSE(s_dmx.sockets[1] >= 0, ESP_FAIL, err, TAG, "打开Art-Net端口失败");
+    }
+    
+    s_dmx.running = true;
+    BaseType_t created = xTaskCreate(ws2812b_dmx_task, "ws2812b_dmx", WS2812B_DMX_TASK_STACK_SIZE,
+                                     NULL, WS2812B_DMX_TASK_PRIORITY, &s_dmx.task);
+    ESP_GOTO_ON_FALSE(created == pdPASS, ESP_ERR_NO_MEM, err, TAG, "创建接收任务失败");
+    
+    return ESP_OK;
+
+err:
+    s_dmx.running = false;
+    for (int i = 0; i < 2; i++) {
+        if (s_dmx.sockets[i] >= 0) {
+            close(s_dmx.sockets[i]);
+            s_dmx.sockets[i] = -1;
+        }
+    }
+    return ret;
+}
+
+// 停止接收器：向自己的端口发送一个空包唤醒接收任务，等待其退出
+esp_err_t ws2812b_dmx_stop(void)
+{
+    ESP_RETURN_ON_FALSE(s_dmx.running, ESP_ERR_INVALID_STATE, TAG, "接收器未运行");
+    
+    s_dmx.stop_waiter = xTaskGetCurrentTaskHandle();
+    s_dmx.running = false;
+    
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock >= 0) {
+        struct sockaddr_in addr = {
+            .sin_family = AF_INET,
+            .sin_port = htons(s_dmx.sockets[0] >= 0 ? WS2812B_DMX_E131_PORT : WS2812B_DMX_ARTNET_PORT),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+        };
+        sendto(sock, "", 1, 0, (struct sockaddr *)&addr, sizeof(addr));
+        close(sock);
+    }
+    
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    s_dmx.task = NULL;
+    
+    return ESP_OK;
+}
+
+// 获取接收统计
+esp_err_t ws2812b_dmx_get_stats(ws2812b_dmx_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "参数为空");
+    
+    portENTER_CRITICAL(&s_dmx.lock);
+    *stats = s_dmx.stats;
+    portEXIT_CRITICAL(&s_dmx.lock);
+    
+    return ESP_OK;
+}
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+// 接收处理自检：不经过网络，把构造的数据包直接送入处理函数（接收器运行时不能调用）
+// 解析和序号规则在主机测试中覆盖，这里只检查帧提交和统计；会改写灯带内容
+bool ws2812b_dmx_test_receiver(ws2812b_strip_t *strip)
+{
+    static uint8_t packet[WS2812B_DMX_MAX_PACKET_SIZE];
+    static uint8_t channels[WS2812B_DMX_CHANNELS];
+    size_t len;
+    bool passed = true;
+    
+    if (s_dmx.running) {
+        ESP_LOGE(TAG, "接收器运行中，无法测试");
+        return false;
+    }
+    
+    ws2812b_dmx_config_t config = {
+        .strip = strip,
+        .protocols = WS2812B_DMX_PROTO_E131 | WS2812B_DMX_PROTO_ARTNET,
+        .start_universe = 1,
+    };
+    if (ws2812b_dmx_setup(&config) != ESP_OK) {
+        return false;
+    }
+    
+    for (int i = 0; i < WS2812B_DMX_CHANNELS; i++) {
+        channels[i] = (uint8_t)(i * 7);
+    }
+    
+    // 按序收齐所有宇宙：每轮提交一个完整帧
+    uint16_t universes = s_dmx.universe_count;
+    for (uint8_t seq = 1; seq <= 3; seq++) {
+        for (uint16_t u = 0; u < universes; u++) {
+            len = ws2812b_dmx_build_e131(packet, 1 + u, seq, channels, WS2812B_DMX_CHANNELS);
+            ws2812b_dmx_handle_packet(packet, len);
+        }
+    }
+    
+    // 丢包：宇宙1序号从3跳到6（丢2个）；乱序：随后到达的序号5被丢弃
+    len = ws2812b_dmx_build_artnet(packet, 1, 6, channels, WS2812B_DMX_CHANNELS);
+    ws2812b_dmx_handle_packet(packet, len);
+    len = ws2812b_dmx_build_artnet(packet, 1, 5, channels, WS2812B_DMX_CHANNELS);
+    ws2812b_dmx_handle_packet(packet, len);
+    
+    // 多个宇宙时，宇宙1再次到达而其他宇宙未到：先提交未收齐的帧
+    if (universes > 1) {
+        len = ws2812b_dmx_build_artnet(packet, 1, 7, channels, WS2812B_DMX_CHANNELS);
+        ws2812b_dmx_handle_packet(packet, len);
+    }
+    ws2812b_dmx_handle_timeout();
+    
+    uint32_t expected_frames = 3 + 1 + (universes > 1 ? 1 : 0);
+    uint32_t expected_partial = universes > 1 ? 2 : 0;
+    ws2812b_dmx_stats_t stats = s_dmx.stats;
+    ESP_LOGI(TAG, "包 %lu, 丢包 %lu, 乱序 %lu, 帧 %lu（未收齐 %lu）", (unsigned long)stats.packets,
+             (unsigned long)stats.dropped_packets, (unsigned long)stats.late_packets,
+             (unsigned long)stats.frames, (unsigned long)stats.partial_frames);
+    if (stats.dropped_packets != 2 || stats.late_packets != 1 || stats.frames != expected_frames ||
+        stats.partial_frames != expected_partial) {
+        ESP_LOGE(TAG, "接收统计与预期不符");
+        passed = false;
+    }
+    
+    ESP_LOGI(TAG, "DMX接收自检%s", passed ? "通过" : "失败");
+    ws2812b_strip_clear(strip);
+    ws2812b_strip_refresh(strip);
+    return passed;
+}
@@ -0,0 +1,90 @@
+#ifndef WS2812B_DMX_H
+#define WS2812B_DMX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "ws2812b_driver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// E1.31（sACN）/ Art-Net接收：按DMX宇宙把通道数据直接写入灯带后台缓冲区
+// 每个宇宙512个通道，RGB灯带每宇宙170个LED（RGBW为128个），宇宙编号从start_universe起连续分配
+
+// 协议（可以同时启用）
+#define WS2812B_DMX_PROTO_E131      (1 << 0)    // E1.31，UDP端口5568，组播239.255.x.y
+#define WS2812B_DMX_PROTO_ARTNET    (1 << 1)    // Art-Net，UDP端口6454
+
+#define WS2812B_DMX_CHANNELS        512                         // 每个宇宙的通道数
+#define WS2812B_DMX_MAX_PACKET_SIZE (126 + WS2812B_DMX_CHANNELS)  // 最长的数据包：E1.31包头126字节加512个通道
+
+// 解析结果：data指向原始数据包内部，不拷贝
+typedef struct {
+    uint8_t protocol;                   // WS2812B_DMX_PROTO_E131或WS2812B_DMX_PROTO_ARTNET
+    uint16_t universe;                  // 宇宙编号
+    uint8_t sequence;                   // 序号：E1.31为0-255循环（0有效）；Art-Net为1-255循环，0表示不使用序号
+    bool preview;                       // E1.31预览数据（不应输出）
+    bool terminated;                    // E1.31流结束
+    const uint8_t *data;                // DMX通道1起始（不含起始码）
+    uint16_t length;                    // 通道数（最多512）
+} ws2812b_dmx_packet_t;
+
+// 数据源状态变化回调（在接收任务中调用）：active为true表示开始收到数据，
+// false表示WS2812B_DMX_TIMEOUT_MS内没有数据或发送方结束了数据流
+typedef void (*ws2812b_dmx_source_cb_t)(bool active, void *user_ctx);
+
+// 接收配置
+typedef struct {
+    ws2812b_strip_t *strip;             // 输出灯带
+    uint8_t protocols;                  // 启用的协议（WS2812B_DMX_PROTO_*）
+    uint16_t start_universe;            // 灯带第一个LED所在的宇宙
+    ws2812b_dmx_source_cb_t on_source;  // 可选：数据源状态变化回调
+    void *user_ctx;
+    SemaphoreHandle_t strip_lock;       // 可选：与其他数据源共用灯带时的互斥锁，写入像素和提交显示都在锁内进行
+} ws2812b_dmx_config_t;
+
+// 接收统计
+typedef struct {
+    uint32_t packets;                   // 已接受的数据包
+    uint32_t packets_per_sec;           // 最近一个统计周期的包速率
+    uint32_t dropped_packets;           // 按序号推算丢失的数据包
+    uint32_t late_packets;              // 乱序到达（序号落后）而丢弃的数据包
+    uint32_t invalid_packets;           // 格式错误或不属于本灯带的数据包
+    uint32_t frames;                    // 已提交显示的帧
+    uint32_t partial_frames;            // 未收齐所有宇宙就提交的帧（丢包或超时）
+} ws2812b_dmx_stats_t;
+
+// 数据包格式（ws2812b_dmx_parse.c）：只用到标准C，不依赖网络和灯带，在开发机上测试（host/test_dmx.c）
+// 解析一个UDP负载
+esp_err_t ws2812b_dmx_parse(const uint8_t *buf, size_t len, ws2812b_dmx_packet_t *packet);
+// 数据包是否带序号：E1.31总是带序号，Art-Net序号为0表示发送方不使用
+bool ws2812b_dmx_has_sequence(const ws2812b_dmx_packet_t *packet);
+// 序号相对上一个包前进的步数，0和负数表示重复或落后
+int ws2812b_dmx_sequence_diff(uint8_t protocol, uint8_t sequence, uint8_t last);
+// 宇宙在灯带内的序号（从0开始），不属于本灯带时返回-1
+int ws2812b_dmx_universe_index(uint16_t universe, uint16_t start_universe, uint16_t universe_count);
+// 构造测试用的数据包，返回长度；buf至少WS2812B_DMX_MAX_PACKET_SIZE字节
+size_t ws2812b_dmx_build_e131(uint8_t *buf, uint16_t universe, uint8_t sequence,
+                              const uint8_t *data, uint16_t length);
+size_t ws2812b_dmx_build_artnet(uint8_t *buf, uint16_t universe, uint8_t sequence,
+                                const uint8_t *data, uint16_t length);
+
+// 接收器接口（全局唯一）：通常在获取IP后启动
+esp_err_t ws2812b_dmx_start(const ws2812b_dmx_config_t *config);
+esp_err_t ws2812b_dmx_stop(void);
+esp_err_t ws2812b_dmx_get_stats(ws2812b_dmx_stats_t *stats);
+
+// 测试函数：构造E1.31/Art-Net数据包（含丢包和乱序）送入接收处理，检查帧提交和统计
+// 解析和序号规则由主机测试覆盖
+bool ws2812b_dmx_test_receiver(ws2812b_strip_t *strip);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS2812B_DMX_H
@@ -0,0 +1,172 @@
+// E1.31 / Art-Net数据包格式：解析、序号比较和构造测试数据包
+// 只用到标准C，不依赖网络和灯带，可以在开发机上编译测试（见host/test_dmx.c）
+#include "ws2812b_dmx.h"
+#include <string.h>
+
+// E1.31数据包（ANSI E1.31-2018）：根层、帧层、DMP层的固定偏移
+#define E131_ACN_ID_OFFSET          4
+#define E131_ROOT_VECTOR_OFFSET     18
+#define E131_FRAME_VECTOR_OFFSET    40
+#define E131_SEQUENCE_OFFSET        111
+#define E131_OPTIONS_OFFSET         112
+#define E131_UNIVERSE_OFFSET        113
+#define E131_DMP_VECTOR_OFFSET      117
+#define E131_PROPERTY_COUNT_OFFSET  123
+#define E131_START_CODE_OFFSET      125
+#define E131_DATA_OFFSET            126
+#define E131_ROOT_VECTOR_DATA       0x00000004
+#define E131_FRAME_VECTOR_DATA      0x00000002
+#define E131_DMP_VECTOR_SET         0x02
+#define E131_OPTION_PREVIEW         0x80
+#define E131_OPTION_TERMINATED      0x40
+
+// Art-Net ArtDmx数据包
+#define ARTNET_OPCODE_OFFSET        8
+#define ARTNET_SEQUENCE_OFFSET      12
+#define ARTNET_UNIVERSE_OFFSET      14
+#define ARTNET_LENGTH_OFFSET        16
+#define ARTNET_DATA_OFFSET          18
+#define ARTNET_OPCODE_DMX           0x5000
+
+static const uint8_t e131_acn_id[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+static const uint8_t artnet_id[8] = {'A', 'r', 't', '-', 'N', 'e', 't', 0};
+
+static inline uint16_t ws2812b_dmx_be16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+static inline uint32_t ws2812b_dmx_be32(const uint8_t *p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+// 解析E1.31数据包
+static esp_err_t ws2812b_dmx_parse_e131(const uint8_t *buf, size_t len, ws2812b_dmx_packet_t *packet)
+{
+    if (len < E131_DATA_OFFSET ||
+        ws2812b_dmx_be32(buf + E131_ROOT_VECTOR_OFFSET) != E131_ROOT_VECTOR_DATA ||
+        ws2812b_dmx_be32(buf + E131_FRAME_VECTOR_OFFSET) != E131_FRAME_VECTOR_DATA ||
+        buf[E131_DMP_VECTOR_OFFSET] != E131_DMP_VECTOR_SET) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 属性数量包含起始码；只处理起始码为0的DMX数据
+    uint16_t count = ws2812b_dmx_be16(buf + E131_PROPERTY_COUNT_OFFSET);
+    if (count < 1 || count - 1 > WS2812B_DMX_CHANNELS || E131_START_CODE_OFFSET + (size_t)count > len ||
+        buf[E131_START_CODE_OFFSET] != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    packet->protocol = WS2812B_DMX_PROTO_E131;
+    packet->universe = ws2812b_dmx_be16(buf + E131_UNIVERSE_OFFSET);
+    packet->sequence = buf[E131_SEQUENCE_OFFSET];
+    packet->preview = buf[E131_OPTIONS_OFFSET] & E131_OPTION_PREVIEW;
+    packet->terminated = buf[E131_OPTIONS_OFFSET] & E131_OPTION_TERMINATED;
+    packet->data = buf + E131_DATA_OFFSET;
+    packet->length = count - 1;
+    return ESP_OK;
+}
+
+// 解析Art-Net ArtDmx数据包（其他操作码忽略）
+static esp_err_t ws2812b_dmx_parse_artnet(const uint8_t *buf, size_t len, ws2812b_dmx_packet_t *packet)
+{
+    if (len < ARTNET_DATA_OFFSET ||
+        (buf[ARTNET_OPCODE_OFFSET] | buf[ARTNET_OPCODE_OFFSET + 1] << 8) != ARTNET_OPCODE_DMX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    uint16_t length = ws2812b_dmx_be16(buf + ARTNET_LENGTH_OFFSET);
+    if (length > WS2812B_DMX_CHANNELS || ARTNET_DATA_OFFSET + (size_t)length > len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 端口地址：低字节为SubUni，高7位为Net
+    packet->protocol = WS2812B_DMX_PROTO_ARTNET;
+    packet->universe = (uint16_t)((buf[ARTNET_UNIVERSE_OFFSET + 1] & 0x7F) << 8 | buf[ARTNET_UNIVERSE_OFFSET]);
+    packet->sequence = buf[ARTNET_SEQUENCE_OFFSET];
+    packet->preview = false;
+    packet->terminated = false;
+    packet->data = buf + ARTNET_DATA_OFFSET;
+    packet->length = length;
+    return ESP_OK;
+}
+
+// 解析一个UDP负载：按包头标识区分E1.31和Art-Net
+esp_err_t ws2812b_dmx_parse(const uint8_t *buf, size_t len, ws2812b_dmx_packet_t *packet)
+{
+    if (!buf || !packet) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (len >= E131_ACN_ID_OFFSET + sizeof(e131_acn_id) &&
+        memcmp(buf + E131_ACN_ID_OFFSET, e131_acn_id, sizeof(e131_acn_id)) == 0) {
+        return ws2812b_dmx_parse_e131(buf, len, packet);
+    }
+    if (len >= sizeof(artnet_id) && memcmp(buf, artnet_id, sizeof(artnet_id)) == 0) {
+        return ws2812b_dmx_parse_artnet(buf, len, packet);
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+// 数据包是否带序号
+bool ws2812b_dmx_has_sequence(const ws2812b_dmx_packet_t *packet)
+{
+    return packet->protocol == WS2812B_DMX_PROTO_E131 || packet->sequence != 0;
+}
+
+// 序号相对上一个包前进的步数，取值-127到128，0和负数表示重复或落后
+// E1.31按0-255循环；Art-Net按1-255循环，从255回到1时跳过的0不计
+int ws2812b_dmx_sequence_diff(uint8_t protocol, uint8_t sequence, uint8_t last)
+{
+    if (protocol == WS2812B_DMX_PROTO_ARTNET) {
+        int diff = ((int)sequence - last + 255) % 255;
+        return diff > 127 ? diff - 255 : diff;
+    }
+    return (int8_t)(sequence - last);
+}
+
+// 宇宙在灯带内的序号，不属于本灯带时返回-1
+int ws2812b_dmx_universe_index(uint16_t universe, uint16_t start_universe, uint16_t universe_count)
+{
+    if (universe < start_universe || universe - start_universe >= universe_count) {
+        return -1;
+    }
+    return universe - start_universe;
+}
+
+// 构造E1.31数据包，返回长度
+size_t ws2812b_dmx_build_e131(uint8_t *buf, uint16_t universe, uint8_t sequence,
+                              const uint8_t *data, uint16_t length)
+{
+    memset(buf, 0, E131_DATA_OFFSET);
+    buf[1] = 0x10;
+    memcpy(buf + E131_ACN_ID_OFFSET, e131_acn_id, sizeof(e131_acn_id));
+    buf[E131_ROOT_VECTOR_OFFSET + 3] = E131_ROOT_VECTOR_DATA;
+    buf[E131_FRAME_VECTOR_OFFSET + 3] = E131_FRAME_VECTOR_DATA;
+    buf[E131_SEQUENCE_OFFSET] = sequence;
+    buf[E131_UNIVERSE_OFFSET] = universe >> 8;
+    buf[E131_UNIVERSE_OFFSET + 1] = universe & 0xFF;
+    buf[E131_DMP_VECTOR_OFFSET] = E131_DMP_VECTOR_SET;
+    buf[E131_PROPERTY_COUNT_OFFSET] = (length + 1) >> 8;
+    buf[E131_PROPERTY_COUNT_OFFSET + 1] = (length + 1) & 0xFF;
+    memcpy(buf + E131_DATA_OFFSET, data, length);
+    return E131_DATA_OFFSET + length;
+}
+
+// 构造Art-Net ArtDmx数据包，返回长度
+size_t ws2812b_dmx_build_artnet(uint8_t *buf, uint16_t universe, uint8_t sequence,
+                                const uint8_t *data, uint16_t length)
+{
+    memset(buf, 0, ARTNET_DATA_OFFSET);
+    memcpy(buf, artnet_id, sizeof(artnet_id));
+    buf[ARTNET_OPCODE_OFFSET + 1] = ARTNET_OPCODE_DMX >> 8;
+    buf[11] = 14;   // 协议版本
+    buf[ARTNET_SEQUENCE_OFFSET] = sequence;
+    buf[ARTNET_UNIVERSE_OFFSET] = universe & 0xFF;
+    buf[ARTNET_UNIVERSE_OFFSET + 1] = universe >> 8;
+    buf[ARTNET_LENGTH_OFFSET] = length >> 8;
+    buf[ARTNET_LENGTH_OFFSET + 1] = length & 0xFF;
+    memcpy(buf + ARTNET_DATA_OFFSET, data, length);
+    return ARTNET_DATA_OFFSET + length;
+}
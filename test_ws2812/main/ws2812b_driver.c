@@ -1,176 +1,930 @@
 #include "ws2812b_driver.h"
+#include "ws2812b_backend.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_attr.h"
+#include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "WS2812B";
 
-// 全局变量
-static rmt_channel_handle_t tx_chan = NULL;
-static ws2812b_color_t led_strip_pixels[WS2812B_LED_COUNT];
-static bool driver_initialized = false;
-
-// WS2812B时序参数（基于10MHz时钟）
-static const rmt_symbol_word_t ws2812b_t0h = {
-    .level0 = 1,
-    .duration0 = 4,  // 350ns / 100ns = 3.5 ≈ 4
-    .level1 = 0,
-    .duration1 = 8,  // 800ns / 100ns = 8
+// 灯带对象
+struct ws2812b_strip_t {
+    ws2812b_backend_t *backend;                 // 发送后端（RMT或SPI）
+    uint16_t led_count;                         // LED数量
+    uint8_t bytes_per_pixel;                    // 每像素字节数（3=RGB，4=RGBW）
+    uint8_t *front_buffer;                      // 后端正在发送的帧
+    uint8_t *back_buffer;                       // 供ws2812b_strip_set_*写入的帧
+    void *buffer_alloc;                         // 内部分配的缓冲区（调用者提供时为NULL）
+    volatile uint32_t frames_in_flight;         // 已提交但未发送完成的帧数
+    volatile uint32_t frames_done;              // 已发送完成的帧数
+    int64_t submit_time_us;                     // 当前帧提交时间
+    volatile int64_t last_frame_us;             // 上一帧从提交到发送完成的耗时
+    portMUX_TYPE lock;
+    ws2812b_done_callback_t done_callback;      // 用户注册的发送完成回调
+    void *done_callback_ctx;
+    uint8_t lut[2][256];                        // 亮度/伽马查找表（双份，修改时不影响正在发送的帧）
+    uint8_t active_lut;                         // 下一帧使用的查找表
+    uint8_t tx_lut;                             // 正在发送的帧使用的查找表
+    uint8_t brightness;                         // 当前亮度（0-255）
+    bool gamma;                                 // 是否启用伽马校正
+    ws2812b_color16_t *hd_buffer;               // 抖动模式：16位像素（非抖动模式为NULL）
+    uint8_t *dither_error;                      // 抖动模式：每通道的量化误差，跨帧保留
+    uint32_t dither_scale;                      // 抖动模式：亮度系数（brightness * 65536 / 255）
+    bool packed;                                // 紧凑模式：缓冲区保存线上顺序、已应用亮度的字节
+    const uint8_t *order;                       // 紧凑模式：写入时使用的颜色顺序映射
+    uint16_t dirty_start;                       // 后台缓冲区自上次发送以来被写过的像素范围[dirty_start, dirty_end)
+    uint16_t dirty_end;                         // dirty_start >= dirty_end表示没有写入
+    bool force_full;                            // 下一帧必须整帧发送（查找表已切换或显示内容未知）
+    uint32_t frames_skipped;                    // 帧内容未变化而跳过的刷新次数
+    uint32_t frame_time_us;                     // 整帧线上时间（含复位码），决定最高帧率
 };
 
-static const rmt_symbol_word_t ws2812b_t1h = {
-    .level0 = 1,
-    .duration0 = 7,  // 700ns / 100ns = 7
-    .level1 = 0,
-    .duration1 = 6,  // 600ns / 100ns = 6
-};
+// 全局变量：兼容旧接口的默认灯带
+static ws2812b_strip_t *default_strip = NULL;
+
+// 已创建的灯带（每条灯带独占一个RMT发送通道或SPI主机）
+static ws2812b_strip_t *strip_registry[WS2812B_MAX_STRIPS] = {0};
+static portMUX_TYPE registry_lock = portMUX_INITIALIZER_UNLOCKED;
 
-// 创建WS2812B编码器
-static esp_err_t ws2812b_rmt_new_encoder(rmt_encoder_handle_t *ret_encoder)
+// 后端发送完成通知（中断上下文）
+static bool IRAM_ATTR ws2812b_strip_on_done(void *user_ctx)
 {
-    esp_err_t ret = ESP_OK;
+    ws2812b_strip_t *strip = (ws2812b_strip_t *)user_ctx;
     
-    // 创建字节编码器
-    rmt_bytes_encoder_config_t bytes_encoder_config = {
-        .bit0 = ws2812b_t0h,
-        .bit1 = ws2812b_t1h,
-        .flags.msb_first = 1,
-    };
+    portENTER_CRITICAL_ISR(&strip->lock);
+    if (strip->frames_in_flight > 0) {
+        strip->frames_in_flight--;
+    }
+    strip->frames_done++;
+    strip->last_frame_us = esp_timer_get_time() - strip->submit_time_us;
+    portEXIT_CRITICAL_ISR(&strip->lock);
     
-    ESP_RETURN_ON_ERROR(rmt_new_bytes_encoder(&bytes_encoder_config, ret_encoder), 
-                      TAG, "创建字节编码器失败");
+    ws2812b_done_callback_t callback = strip->done_callback;
+    if (callback) {
+        return callback(strip->done_callback_ctx);
+    }
     
-    return ESP_OK;
+    return false;
 }
 
-// 初始化WS2812B驱动
-esp_err_t ws2812b_init(gpio_num_t gpio_num)
+// 登记灯带，供ws2812b_refresh_all()使用
+static esp_err_t ws2812b_registry_add(ws2812b_strip_t *strip)
 {
-    if (driver_initialized) {
-        ESP_LOGW(TAG, "驱动已经初始化");
-        return ESP_OK;
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    
+    portENTER_CRITICAL(&registry_lock);
+    for (int i = 0; i < WS2812B_MAX_STRIPS; i++) {
+        if (!strip_registry[i]) {
+            strip_registry[i] = strip;
+            ret = ESP_OK;
+            break;
+        }
     }
+    portEXIT_CRITICAL(&registry_lock);
     
-    ESP_LOGI(TAG, "初始化WS2812B驱动，GPIO: %d", gpio_num);
+    return ret;
+}
+
+// 注销灯带
+static void ws2812b_registry_remove(ws2812b_strip_t *strip)
+{
+    portENTER_CRITICAL(&registry_lock);
+    for (int i = 0; i < WS2812B_MAX_STRIPS; i++) {
+        if (strip_registry[i] == strip) {
+            strip_registry[i] = NULL;
+        }
+    }
+    portEXIT_CRITICAL(&registry_lock);
+}
+
+// 创建灯带
+esp_err_t ws2812b_strip_new(const ws2812b_strip_config_t *config, ws2812b_strip_t **ret_strip)
+{
+    esp_err_t ret = ESP_OK;
+    ws2812b_strip_t *strip = NULL;
     
-    // 创建RMT发送通道
-    rmt_tx_channel_config_t tx_chan_config = {
-        .gpio_num = gpio_num,
-        .clk_src = RMT_CLK_SRC_DEFAULT,
-        .resolution_hz = 10000000,  // 10MHz
-        .mem_block_symbols = 64,
-        .trans_queue_depth = 4,
+    ESP_RETURN_ON_FALSE(config && ret_strip, ESP_ERR_INVALID_ARG, TAG, "参数为空");
+    ESP_RETURN_ON_FALSE(config->led_count > 0, ESP_ERR_INVALID_ARG, TAG, "LED数量必须大于0");
+    ESP_RETURN_ON_FALSE(config->color_order < WS2812B_ORDER_MAX, ESP_ERR_INVALID_ARG, TAG,
+                        "不支持的颜色顺序: %d", config->color_order);
+    ESP_RETURN_ON_FALSE(!(config->flags.packed && config->flags.dithering), ESP_ERR_INVALID_ARG, TAG,
+                        "紧凑模式与抖动模式不能同时启用");
+    
+    // 未指定芯片时为WS2812B，使用配置中的颜色顺序
+    ws2812b_chip_t chip = config->chip ? *config->chip : ws2812b_chip_ws2812b;
+    if (!config->chip) {
+        chip.color_order = config->color_order;
+    }
+    ESP_RETURN_ON_FALSE(chip.bytes_per_pixel == 3 || chip.bytes_per_pixel == 4, ESP_ERR_INVALID_ARG, TAG,
+                        "不支持的每像素字节数: %d", chip.bytes_per_pixel);
+    ESP_RETURN_ON_FALSE(chip.color_order < WS2812B_ORDER_MAX, ESP_ERR_INVALID_ARG, TAG,
+                        "不支持的颜色顺序: %d", chip.color_order);
+    ESP_RETURN_ON_FALSE(!(config->flags.dithering && chip.bytes_per_pixel != 3), ESP_ERR_INVALID_ARG, TAG,
+                        "抖动模式仅支持RGB芯片");
+    
+    ESP_LOGI(TAG, "创建灯带，GPIO: %d，LED数量: %d，芯片: %s", config->gpio_num, config->led_count, chip.name);
+    
+    strip = calloc(1, sizeof(ws2812b_strip_t));
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_NO_MEM, TAG, "分配灯带对象失败");
+    
+    strip->led_count = config->led_count;
+    strip->bytes_per_pixel = chip.bytes_per_pixel;
+    strip->lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    strip->brightness = WS2812B_DEFAULT_BRIGHTNESS;
+    strip->gamma = WS2812B_GAMMA_ENABLE;
+    strip->packed = config->flags.packed;
+    strip->order = ws2812b_order_map[chip.color_order];
+    strip->dirty_start = config->led_count;
+    strip->force_full = true;
+    
+    // 整帧线上时间按较长的那种位计算：每像素bytes_per_pixel×8位，末尾加复位码
+    uint32_t bit_ns = chip.t0h_ns + chip.t0l_ns;
+    if (chip.t1h_ns + chip.t1l_ns > bit_ns) {
+        bit_ns = chip.t1h_ns + chip.t1l_ns;
+    }
+    strip->frame_time_us = (uint32_t)(((uint64_t)config->led_count * chip.bytes_per_pixel * 8 * bit_ns + 999) / 1000)
+                           + chip.reset_us;
+    
+    if (config->flags.dithering) {
+        // 抖动模式在16位下完成伽马和亮度，编码时使用恒等查找表
+        strip->hd_buffer = calloc(config->led_count, sizeof(ws2812b_color16_t));
+        strip->dither_error = calloc(config->led_count, 3);
+        ESP_GOTO_ON_FALSE(strip->hd_buffer && strip->dither_error, ESP_ERR_NO_MEM, err, TAG, "分配抖动缓冲区失败");
+        strip->dither_scale = ((uint32_t)strip->brightness << 16) / 255;
+        ws2812b_build_lut(strip->lut[strip->active_lut], 255, false);
+    } else {
+        ws2812b_build_lut(strip->lut[strip->active_lut], strip->brightness, strip->gamma);
+    }
+    
+    // 帧缓冲区：按实际LED数量分配前/后台两帧，或使用调用者提供的区域
+    size_t buffer_size = WS2812B_STRIP_BUFFER_SIZE_BPP(config->led_count, chip.bytes_per_pixel);
+    uint8_t *buffer = config->buffer;
+    if (!buffer) {
+        strip->buffer_alloc = calloc(1, buffer_size);
+        ESP_GOTO_ON_FALSE(strip->buffer_alloc, ESP_ERR_NO_MEM, err, TAG, "分配帧缓冲区失败");
+        buffer = strip->buffer_alloc;
+    } else {
+        memset(buffer, 0, buffer_size);
+    }
+    strip->front_buffer = buffer;
+    strip->back_buffer = buffer + buffer_size / 2;
+    
+    // 创建发送后端（整个灯带生命周期内复用，刷新时不再分配内存）
+    ws2812b_backend_config_t backend_config = {
+        .gpio_num = config->gpio_num,
+        .led_count = config->led_count,
+        .color_order = chip.color_order,
+        .chip = &chip,
+        .mem_block_symbols = config->mem_block_symbols,
+        .streaming = config->flags.streaming,
+        .spi_host = config->spi_host,
+        .on_done = ws2812b_strip_on_done,
+        .user_ctx = strip,
     };
+    switch (config->backend) {
+    case WS2812B_BACKEND_RMT:
+        ret = ws2812b_new_rmt_backend(&backend_config, &strip->backend);
+        break;
+    case WS2812B_BACKEND_SPI:
+        ret = ws2812b_new_spi_backend(&backend_config, &strip->backend);
+        break;
+    default:
+        ret = ESP_ERR_INVALID_ARG;
+        break;
+    }
+    ESP_GOTO_ON_ERROR(ret, err, TAG, "创建发送后端失败");
     
-    ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&tx_chan_config, &tx_chan), TAG, "创建RMT通道失败");
+    // 登记灯带
+    ESP_GOTO_ON_ERROR(ws2812b_registry_add(strip), err, TAG, "灯带数量超过上限: %d", WS2812B_MAX_STRIPS);
     
-    // 启用RMT通道
-    ESP_RETURN_ON_ERROR(rmt_enable(tx_chan), TAG, "启用RMT通道失败");
+    *ret_strip = strip;
+    ESP_LOGI(TAG, "灯带创建成功");
+    return ESP_OK;
     
-    // 初始化LED数组
-    memset(led_strip_pixels, 0, sizeof(led_strip_pixels));
+err:
+    if (strip->backend) {
+        strip->backend->del(strip->backend);
+    }
+    free(strip->hd_buffer);
+    free(strip->dither_error);
+    free(strip->buffer_alloc);
+    free(strip);
+    return ret;
+}
+
+// 删除灯带
+esp_err_t ws2812b_strip_del(ws2812b_strip_t *strip)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "灯带为空");
     
-    driver_initialized = true;
-    ESP_LOGI(TAG, "WS2812B驱动初始化成功");
+    ws2812b_registry_remove(strip);
+    
+    // 后端删除时会等待正在发送的帧完成，避免缓冲区仍被读取
+    strip->backend->del(strip->backend);
+    free(strip->hd_buffer);
+    free(strip->dither_error);
+    free(strip->buffer_alloc);
+    free(strip);
     
     return ESP_OK;
 }
 
+// 获取LED数量
+uint16_t ws2812b_strip_get_led_count(const ws2812b_strip_t *strip)
+{
+    return strip ? strip->led_count : 0;
+}
+
+// 获取每像素字节数（3=RGB，4=RGBW）
+uint8_t ws2812b_strip_get_bytes_per_pixel(const ws2812b_strip_t *strip)
+{
+    return strip ? strip->bytes_per_pixel : 0;
+}
+
+// 获取整帧线上时间（微秒，含复位码）
+uint32_t ws2812b_strip_get_frame_time_us(const ws2812b_strip_t *strip)
+{
+    return strip ? strip->frame_time_us : 0;
+}
+
+// 获取灯带能达到的最高帧率：每帧至少占用一整帧的线上时间
+uint32_t ws2812b_strip_get_max_fps(const ws2812b_strip_t *strip)
+{
+    return strip ? 1000000 / strip->frame_time_us : 0;
+}
+
+// 8位颜色扩展为16位（255 -> 65535）
+static inline ws2812b_color16_t ws2812b_color_to_16(ws2812b_color_t color)
+{
+    return (ws2812b_color16_t){color.red * 257, color.green * 257, color.blue * 257};
+}
+
+// 颜色转换为缓冲区中的一个像素：紧凑模式下按线上顺序并应用亮度/伽马，否则按RGB(W)原样保存
+static inline void ws2812b_store_color(const ws2812b_strip_t *strip, ws2812b_color_t color, uint8_t *out)
+{
+    if (strip->packed) {
+        const uint8_t *lut = strip->lut[strip->active_lut];
+        const uint8_t *rgbw = (const uint8_t *)&color;
+        for (int i = 0; i < strip->bytes_per_pixel; i++) {
+            out[i] = lut[rgbw[strip->order[i]]];
+        }
+    } else {
+        memcpy(out, &color, strip->bytes_per_pixel);
+    }
+}
+
+// 后台缓冲区中第index个像素的地址
+static inline uint8_t *ws2812b_back_pixel(const ws2812b_strip_t *strip, uint16_t index)
+{
+    return strip->back_buffer + (size_t)index * strip->bytes_per_pixel;
+}
+
+// 记录被写入的像素范围[start, start + count)，刷新时只比较和同步这一段
+static inline void ws2812b_mark_dirty(ws2812b_strip_t *strip, uint16_t start, uint16_t count)
+{
+    if (start < strip->dirty_start) {
+        strip->dirty_start = start;
+    }
+    if (start + count > strip->dirty_end) {
+        strip->dirty_end = start + count;
+    }
+}
+
 // 设置单个像素颜色
-esp_err_t ws2812b_set_pixel(uint16_t pixel_index, ws2812b_color_t color)
+esp_err_t ws2812b_strip_set_pixel(ws2812b_strip_t *strip, uint16_t pixel_index, ws2812b_color_t color)
 {
-    if (!driver_initialized) {
-        ESP_LOGE(TAG, "驱动未初始化");
-        return ESP_ERR_INVALID_STATE;
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "灯带为空");
+    
+    if (pixel_index >= strip->led_count) {
+        ESP_LOGE(TAG, "像素索引超出范围: %d", pixel_index);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (strip->hd_buffer) {
+        strip->hd_buffer[pixel_index] = ws2812b_color_to_16(color);
+    } else {
+        ws2812b_store_color(strip, color, ws2812b_back_pixel(strip, pixel_index));
     }
+    ws2812b_mark_dirty(strip, pixel_index, 1);
+    return ESP_OK;
+}
+
+// 设置单个像素的16位颜色（抖动模式），非抖动模式下取高8位
+esp_err_t ws2812b_strip_set_pixel16(ws2812b_strip_t *strip, uint16_t pixel_index, ws2812b_color16_t color)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "灯带为空");
     
-    if (pixel_index >= WS2812B_LED_COUNT) {
+    if (pixel_index >= strip->led_count) {
         ESP_LOGE(TAG, "像素索引超出范围: %d", pixel_index);
         return ESP_ERR_INVALID_ARG;
     }
     
-    led_strip_pixels[pixel_index] = color;
+    if (strip->hd_buffer) {
+        strip->hd_buffer[pixel_index] = color;
+    } else {
+        ws2812b_color_t color8 = {color.red >> 8, color.green >> 8, color.blue >> 8, 0};
+        ws2812b_store_color(strip, color8, ws2812b_back_pixel(strip, pixel_index));
+    }
+    ws2812b_mark_dirty(strip, pixel_index, 1);
+    return ESP_OK;
+}
+
+// 检查像素范围[start, start + count)
+#define WS2812B_CHECK_RANGE(strip, start, count)                                        \
+    ESP_RETURN_ON_FALSE((uint32_t)(start) + (count) <= (strip)->led_count, ESP_ERR_INVALID_ARG, \
+                        TAG, "像素范围超出: %d+%d", (int)(start), (int)(count))
+
+// 用同一颜色填充一段像素
+// 颜色只转换一次；三个字节相同时用memset，否则先写一个像素再成倍复制已写好的部分
+esp_err_t ws2812b_strip_fill(ws2812b_strip_t *strip, uint16_t start, uint16_t count, ws2812b_color_t color)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "灯带为空");
+    WS2812B_CHECK_RANGE(strip, start, count);
+    
+    if (count == 0) {
+        return ESP_OK;
+    }
+    
+    ws2812b_mark_dirty(strip, start, count);
+    
+    if (strip->hd_buffer) {
+        ws2812b_color16_t color16 = ws2812b_color_to_16(color);
+        for (int i = start; i < start + count; i++) {
+            strip->hd_buffer[i] = color16;
+        }
+        return ESP_OK;
+    }
+    
+    uint8_t *dst = ws2812b_back_pixel(strip, start);
+    size_t size = (size_t)count * strip->bytes_per_pixel;
+    ws2812b_store_color(strip, color, dst);
+    
+    if (memcmp(dst, dst + 1, strip->bytes_per_pixel - 1) == 0) {
+        memset(dst, dst[0], size);
+        return ESP_OK;
+    }
+    
+    for (size_t done = strip->bytes_per_pixel; done < size; done *= 2) {
+        memcpy(dst + done, dst, done < size - done ? done : size - done);
+    }
+    
     return ESP_OK;
 }
 
 // 设置所有像素颜色
-esp_err_t ws2812b_set_all_pixels(ws2812b_color_t color)
+esp_err_t ws2812b_strip_set_all_pixels(ws2812b_strip_t *strip, ws2812b_color_t color)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "灯带为空");
+    return ws2812b_strip_fill(strip, 0, strip->led_count, color);
+}
+
+// 从start开始连续设置count个像素
+esp_err_t ws2812b_strip_set_pixels(ws2812b_strip_t *strip, uint16_t start,
+                                   const ws2812b_color_t *colors, uint16_t count)
 {
-    if (!driver_initialized) {
-        ESP_LOGE(TAG, "驱动未初始化");
-        return ESP_ERR_INVALID_STATE;
+    ESP_RETURN_ON_FALSE(strip && colors, ESP_ERR_INVALID_ARG, TAG, "参数为空");
+    WS2812B_CHECK_RANGE(strip, start, count);
+    
+    if (strip->hd_buffer) {
+        for (uint16_t i = 0; i < count; i++) {
+            strip->hd_buffer[start + i] = ws2812b_color_to_16(colors[i]);
+        }
+    } else {
+        uint8_t *dst = ws2812b_back_pixel(strip, start);
+        for (uint16_t i = 0; i < count; i++, dst += strip->bytes_per_pixel) {
+            ws2812b_store_color(strip, colors[i], dst);
+        }
     }
+    ws2812b_mark_dirty(strip, start, count);
+    
+    return ESP_OK;
+}
+
+// 按缓冲区格式直接拷贝像素数据（紧凑模式为线上顺序、已应用亮度的字节，否则为RGB(W)）
+// 适合转发已按灯带格式编排好的数据，不做任何转换
+esp_err_t ws2812b_strip_write_raw(ws2812b_strip_t *strip, uint16_t start, const void *data, uint16_t count)
+{
+    ESP_RETURN_ON_FALSE(strip && data, ESP_ERR_INVALID_ARG, TAG, "参数为空");
+    ESP_RETURN_ON_FALSE(!strip->hd_buffer, ESP_ERR_INVALID_STATE, TAG, "抖动模式不支持原始数据写入");
+    WS2812B_CHECK_RANGE(strip, start, count);
+    
+    memcpy(ws2812b_back_pixel(strip, start), data, (size_t)count * strip->bytes_per_pixel);
+    ws2812b_mark_dirty(strip, start, count);
+    return ESP_OK;
+}
+
+// 按通道顺序写入一段像素：每像素bytes_per_pixel字节，依次为R、G、B（RGBW芯片再加W）
+// 适合DMX、DDP等按RGB排列的网络数据；普通模式下与缓冲区格式相同，整段直接拷贝，
+// 紧凑模式和抖动模式逐像素转换
+esp_err_t ws2812b_strip_write_channels(ws2812b_strip_t *strip, uint16_t start, const uint8_t *data, uint16_t count)
+{
+    ESP_RETURN_ON_FALSE(strip && data, ESP_ERR_INVALID_ARG, TAG, "参数为空");
+    WS2812B_CHECK_RANGE(strip, start, count);
     
-    for (int i = 0; i < WS2812B_LED_COUNT; i++) {
-        led_strip_pixels[i] = color;
+    if (!strip->packed && !strip->hd_buffer) {
+        memcpy(ws2812b_back_pixel(strip, start), data, (size_t)count * strip->bytes_per_pixel);
+    } else {
+        for (uint16_t i = 0; i < count; i++, data += strip->bytes_per_pixel) {
+            ws2812b_color_t color = WS2812B_COLOR_BLACK;
+            memcpy(&color, data, strip->bytes_per_pixel);
+            if (strip->hd_buffer) {
+                strip->hd_buffer[start + i] = ws2812b_color_to_16(color);
+            } else {
+                ws2812b_store_color(strip, color, ws2812b_back_pixel(strip, start + i));
+            }
+        }
     }
+    ws2812b_mark_dirty(strip, start, count);
     
     return ESP_OK;
 }
 
 // 清除所有LED
-esp_err_t ws2812b_clear(void)
+esp_err_t ws2812b_strip_clear(ws2812b_strip_t *strip)
 {
-    return ws2812b_set_all_pixels((ws2812b_color_t){0, 0, 0});
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "灯带为空");
+    
+    // 黑色在所有模式下都是全0字节（查找表lut[0]恒为0）
+    if (strip->hd_buffer) {
+        memset(strip->hd_buffer, 0, strip->led_count * sizeof(ws2812b_color16_t));
+    } else {
+        memset(strip->back_buffer, 0, (size_t)strip->led_count * strip->bytes_per_pixel);
+    }
+    ws2812b_mark_dirty(strip, 0, strip->led_count);
+    
+    return ESP_OK;
 }
 
-// 刷新LED显示
-esp_err_t ws2812b_refresh(void)
+// 交换前后台缓冲区并把新的前台帧的前size字节提交给后端
+// 调用前必须确认上一帧已发送完成
+static esp_err_t ws2812b_swap_and_transmit(ws2812b_strip_t *strip, size_t size, bool nonblocking)
 {
-    if (!driver_initialized) {
-        ESP_LOGE(TAG, "驱动未初始化");
-        return ESP_ERR_INVALID_STATE;
+    // 原子交换前后台缓冲区
+    portENTER_CRITICAL(&strip->lock);
+    uint8_t *frame = strip->back_buffer;
+    strip->back_buffer = strip->front_buffer;
+    strip->front_buffer = frame;
+    strip->frames_in_flight++;
+    strip->submit_time_us = esp_timer_get_time();
+    strip->tx_lut = strip->active_lut;
+    strip->force_full = false;
+    portEXIT_CRITICAL(&strip->lock);
+    
+    // 发送数据，亮度/伽马在编码时查表完成；紧凑模式写入时已处理，直接发送
+    esp_err_t ret = strip->backend->transmit(strip->backend, frame, size,
+                                             strip->packed ? NULL : strip->lut[strip->tx_lut], nonblocking);
+    
+    if (ret != ESP_OK) {
+        portENTER_CRITICAL(&strip->lock);
+        strip->frames_in_flight--;
+        portEXIT_CRITICAL(&strip->lock);
+        ESP_LOGE(TAG, "发送数据失败: %s", esp_err_to_name(ret));
     }
     
-    // 创建编码器
-    rmt_encoder_handle_t encoder = NULL;
-    esp_err_t ret = ws2812b_rmt_new_encoder(&encoder);
+    return ret;
+}
+
+// 抖动模式：把16位像素量化到后台缓冲区
+// 后台缓冲区不在发送中，可以与上一帧的发送重叠进行
+static void ws2812b_prepare_frame(ws2812b_strip_t *strip)
+{
+    if (strip->hd_buffer) {
+        ws2812b_dither_frame(strip->hd_buffer, strip->back_buffer, strip->dither_error,
+                             strip->led_count, strip->dither_scale, strip->gamma);
+    }
+}
+
+// 计算本帧需要发送的字节数，0表示与正在显示的帧相同，可以跳过
+// 前台缓冲区在发送中只被读取，比较不需要等待上一帧完成
+static size_t ws2812b_frame_tx_size(ws2812b_strip_t *strip)
+{
+    size_t full = (size_t)strip->led_count * strip->bytes_per_pixel;
+    
+#if WS2812B_SKIP_UNCHANGED
+    if (strip->force_full) {
+        return full;
+    }
+    
+    // 抖动模式每帧由16位缓冲区整帧重新量化，整帧比较
+    // 量化结果与显示中的帧相同时跳过不影响显示，残余误差会让之后的帧变化后再发送
+    if (strip->hd_buffer) {
+        return memcmp(strip->back_buffer, strip->front_buffer, full) ? full : 0;
+    }
+    
+    if (strip->dirty_start >= strip->dirty_end) {
+        return 0;
+    }
+    
+    // 后台与前台缓冲区只在写入范围内可能不同；范围之后的LED保持原色，只发送到范围末尾
+    size_t start = (size_t)strip->dirty_start * strip->bytes_per_pixel;
+    size_t end = (size_t)strip->dirty_end * strip->bytes_per_pixel;
+    return memcmp(strip->back_buffer + start, strip->front_buffer + start, end - start) ? end : 0;
+#else
+    return full;
+#endif
+}
+
+// 记录一次跳过的刷新：后台缓冲区与前台相同，写入范围清零
+static void ws2812b_skip_frame(ws2812b_strip_t *strip)
+{
+    strip->dirty_start = strip->led_count;
+    strip->dirty_end = 0;
+    portENTER_CRITICAL(&strip->lock);
+    strip->frames_skipped++;
+    portEXIT_CRITICAL(&strip->lock);
+}
+
+// 后台缓冲区延续当前帧内容，只修改部分像素的用法保持不变
+// 交换前两帧只在写入范围内不同，只复制这一段；抖动模式下每帧都由16位缓冲区重新生成，不需要同步
+static void ws2812b_sync_back_buffer(ws2812b_strip_t *strip)
+{
+    if (!strip->hd_buffer && strip->dirty_start < strip->dirty_end) {
+        size_t start = (size_t)strip->dirty_start * strip->bytes_per_pixel;
+        size_t end = (size_t)strip->dirty_end * strip->bytes_per_pixel;
+        memcpy(strip->back_buffer + start, strip->front_buffer + start, end - start);
+    }
+    strip->dirty_start = strip->led_count;
+    strip->dirty_end = 0;
+}
+
+// 交换前后台缓冲区并提交新的前台帧
+// 上一帧仍在发送时先等待其完成（最多一帧的线上时间），之后后台缓冲区即可安全写入
+static esp_err_t ws2812b_submit_frame(ws2812b_strip_t *strip, bool nonblocking)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "灯带为空");
+    
+    ws2812b_prepare_frame(strip);
+    
+    // 内容未变化：不发送，也不等待上一帧
+    size_t size = ws2812b_frame_tx_size(strip);
+    if (size == 0) {
+        ws2812b_skip_frame(strip);
+        return ESP_OK;
+    }
+    
+    // 等待正在发送的前台帧完成，交换后它将成为新的后台缓冲区
+    esp_err_t ret = strip->backend->wait_done(strip->backend, WS2812B_TIMEOUT_MS);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "创建编码器失败");
+        ESP_LOGE(TAG, "等待上一帧发送完成失败: %s", esp_err_to_name(ret));
         return ret;
     }
     
-    // 准备发送数据
-    rmt_transmit_config_t tx_config = {
-        .loop_count = 0,
-    };
+    ret = ws2812b_swap_and_transmit(strip, size, nonblocking);
+    ws2812b_sync_back_buffer(strip);
     
-    // 发送数据
-    ret = rmt_transmit(tx_chan, encoder, led_strip_pixels, 
-                       sizeof(led_strip_pixels), &tx_config);
+    return ret;
+}
+
+// 异步刷新LED显示：交换缓冲区并提交发送后立即返回，不等待本帧发送完成
+// 发送期间可以继续用ws2812b_strip_set_*渲染下一帧
+esp_err_t ws2812b_strip_refresh_async(ws2812b_strip_t *strip)
+{
+    return ws2812b_submit_frame(strip, true);
+}
+
+// 等待所有已提交的帧发送完成
+esp_err_t ws2812b_strip_wait_refresh_done(ws2812b_strip_t *strip, int timeout_ms)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "灯带为空");
+    
+    // 复位码已包含在编码中，完成即已锁存
+    esp_err_t ret = strip->backend->wait_done(strip->backend, timeout_ms);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "等待发送完成失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
     
-    // 删除编码器
-    rmt_del_encoder(encoder);
+    return ESP_OK;
+}
+
+// 下一次刷新整帧发送（即使内容未变化），用于灯带被干扰或重新上电后恢复显示
+esp_err_t ws2812b_strip_invalidate(ws2812b_strip_t *strip)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "灯带为空");
     
+    strip->force_full = true;
+    return ESP_OK;
+}
+
+// 获取尚未发送完成的帧数
+uint32_t ws2812b_strip_get_pending_frames(const ws2812b_strip_t *strip)
+{
+    return strip ? strip->frames_in_flight : 0;
+}
+
+// 获取灯带发送统计
+esp_err_t ws2812b_strip_get_stats(ws2812b_strip_t *strip, ws2812b_strip_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(strip && stats, ESP_ERR_INVALID_ARG, TAG, "参数为空");
+    
+    portENTER_CRITICAL(&strip->lock);
+    stats->frames_done = strip->frames_done;
+    stats->last_frame_us = strip->last_frame_us;
+    stats->late_refills = strip->backend->get_underruns(strip->backend);
+    stats->frames_skipped = strip->frames_skipped;
+    portEXIT_CRITICAL(&strip->lock);
+    
+    return ESP_OK;
+}
+
+// 注册发送完成回调
+esp_err_t ws2812b_strip_register_done_callback(ws2812b_strip_t *strip,
+                                               ws2812b_done_callback_t callback, void *user_ctx)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "灯带为空");
+    
+    // 先清空回调再更新上下文，避免中断中看到不匹配的回调/上下文
+    strip->done_callback = NULL;
+    strip->done_callback_ctx = user_ctx;
+    strip->done_callback = callback;
+    return ESP_OK;
+}
+
+// 按新的亮度/伽马设置重建查找表，下一帧生效
+// 写入未使用的那份表后再切换，正在发送的帧仍使用原来的表
+static esp_err_t ws2812b_update_lut(ws2812b_strip_t *strip, uint8_t brightness, bool gamma)
+{
+    // 抖动模式在量化前处理亮度和伽马，查找表保持恒等
+    if (strip->hd_buffer) {
+        strip->brightness = brightness;
+        strip->gamma = gamma;
+        strip->dither_scale = ((uint32_t)brightness << 16) / 255;
+        return ESP_OK;
+    }
+    
+    // 紧凑模式的查找表只在写入像素时使用，发送中的帧不受影响，直接原地重建
+    if (strip->packed) {
+        ws2812b_build_lut(strip->lut[strip->active_lut], brightness, gamma);
+        strip->brightness = brightness;
+        strip->gamma = gamma;
+        return ESP_OK;
+    }
+    
+    uint8_t next = !strip->active_lut;
+    
+    // 连续修改两次时，空闲的那份表可能正被发送中的帧使用，先等待其完成
+    if (next == strip->tx_lut && strip->frames_in_flight > 0) {
+        esp_err_t ret = strip->backend->wait_done(strip->backend, WS2812B_TIMEOUT_MS);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "等待发送完成失败: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+    
+    ws2812b_build_lut(strip->lut[next], brightness, gamma);
+    strip->brightness = brightness;
+    strip->gamma = gamma;
+    strip->active_lut = next;
+    strip->force_full = true;
+    
+    return ESP_OK;
+}
+
+// 设置灯带亮度（0-255），不修改像素缓冲区
+esp_err_t ws2812b_strip_set_brightness(ws2812b_strip_t *strip, uint8_t brightness)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "灯带为空");
+    
+    if (brightness == strip->brightness) {
+        return ESP_OK;
+    }
+    
+    return ws2812b_update_lut(strip, brightness, strip->gamma);
+}
+
+// 获取灯带亮度
+uint8_t ws2812b_strip_get_brightness(const ws2812b_strip_t *strip)
+{
+    return strip ? strip->brightness : 0;
+}
+
+// 启用/禁用伽马校正
+esp_err_t ws2812b_strip_set_gamma(ws2812b_strip_t *strip, bool enable)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "灯带为空");
+    
+    if (enable == strip->gamma) {
+        return ESP_OK;
+    }
+    
+    return ws2812b_update_lut(strip, strip->brightness, enable);
+}
+
+// 刷新LED显示（阻塞直到发送完成）
+esp_err_t ws2812b_strip_refresh(ws2812b_strip_t *strip)
+{
+    esp_err_t ret = ws2812b_submit_frame(strip, false);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "发送数据失败: %s", esp_err_to_name(ret));
         return ret;
     }
     
-    // 等待传输完成
-    vTaskDelay(pdMS_TO_TICKS(1));
+    return ws2812b_strip_wait_refresh_done(strip, WS2812B_TIMEOUT_MS);
+}
+
+// 获取当前所有灯带（按登记顺序），返回数量
+static int ws2812b_registry_snapshot(ws2812b_strip_t *strips[WS2812B_MAX_STRIPS])
+{
+    int count = 0;
+    
+    portENTER_CRITICAL(&registry_lock);
+    for (int i = 0; i < WS2812B_MAX_STRIPS; i++) {
+        if (strip_registry[i]) {
+            strips[count++] = strip_registry[i];
+        }
+    }
+    portEXIT_CRITICAL(&registry_lock);
+    
+    return count;
+}
+
+// 异步刷新所有灯带：各通道的发送背靠背启动并行进行，总延迟取决于最长的灯带
+esp_err_t ws2812b_refresh_all_async(void)
+{
+    ws2812b_strip_t *strips[WS2812B_MAX_STRIPS];
+    size_t sizes[WS2812B_MAX_STRIPS];
+    int count = ws2812b_registry_snapshot(strips);
+    esp_err_t ret = ESP_OK;
+    
+    // 内容未变化的灯带不参与本次发送
+    int active = 0;
+    for (int i = 0; i < count; i++) {
+        ws2812b_prepare_frame(strips[i]);
+        size_t size = ws2812b_frame_tx_size(strips[i]);
+        if (size == 0) {
+            ws2812b_skip_frame(strips[i]);
+            continue;
+        }
+        strips[active] = strips[i];
+        sizes[active++] = size;
+    }
+    count = active;
     
+    // 先等待所有通道的上一帧完成，保证后面的发送可以连续启动
+    for (int i = 0; i < count; i++) {
+        esp_err_t err = strips[i]->backend->wait_done(strips[i]->backend, WS2812B_TIMEOUT_MS);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "等待上一帧发送完成失败: %s", esp_err_to_name(err));
+            return err;
+        }
+    }
+    
+    // 背靠背启动所有通道的发送
+    for (int i = 0; i < count; i++) {
+        esp_err_t err = ws2812b_swap_and_transmit(strips[i], sizes[i], true);
+        if (err != ESP_OK) {
+            ret = err;
+        }
+    }
+    
+    // 发送已在进行中，再同步各灯带的后台缓冲区
+    for (int i = 0; i < count; i++) {
+        ws2812b_sync_back_buffer(strips[i]);
+    }
+    
+    return ret;
+}
+
+// 刷新所有灯带（阻塞直到全部发送完成）
+esp_err_t ws2812b_refresh_all(void)
+{
+    ws2812b_strip_t *strips[WS2812B_MAX_STRIPS];
+    
+    esp_err_t ret = ws2812b_refresh_all_async();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    int count = ws2812b_registry_snapshot(strips);
+    for (int i = 0; i < count; i++) {
+        esp_err_t err = ws2812b_strip_wait_refresh_done(strips[i], WS2812B_TIMEOUT_MS);
+        if (err != ESP_OK) {
+            ret = err;
+        }
+    }
+    
+    return ret;
+}
+
+// ============================================================================
+// 兼容旧接口：操作由ws2812b_init()创建的默认灯带
+// ============================================================================
+
+// 检查默认灯带是否已初始化
+#define WS2812B_CHECK_DEFAULT_STRIP()               \
+    do {                                            \
+        if (!default_strip) {                       \
+            ESP_LOGE(TAG, "驱动未初始化");           \
+            return ESP_ERR_INVALID_STATE;           \
+        }                                           \
+    } while (0)
+
+// 初始化WS2812B驱动
+esp_err_t ws2812b_init(gpio_num_t gpio_num)
+{
+    if (default_strip) {
+        ESP_LOGW(TAG, "驱动已经初始化");
+        return ESP_OK;
+    }
+    
+    ESP_LOGI(TAG, "初始化WS2812B驱动，GPIO: %d", gpio_num);
+    
+    ws2812b_strip_config_t strip_config = {
+        .gpio_num = gpio_num,
+        .led_count = WS2812B_LED_COUNT,
+        .color_order = WS2812B_COLOR_ORDER,
+        .backend = WS2812B_BACKEND_RMT,
+        .buffer = NULL,
+    };
+    ESP_RETURN_ON_ERROR(ws2812b_strip_new(&strip_config, &default_strip), TAG, "创建默认灯带失败");
+    
+    ESP_LOGI(TAG, "WS2812B驱动初始化成功");
     return ESP_OK;
 }
 
+// 获取默认灯带
+ws2812b_strip_t *ws2812b_get_default_strip(void)
+{
+    return default_strip;
+}
+
+// 设置单个像素颜色
+esp_err_t ws2812b_set_pixel(uint16_t pixel_index, ws2812b_color_t color)
+{
+    WS2812B_CHECK_DEFAULT_STRIP();
+    return ws2812b_strip_set_pixel(default_strip, pixel_index, color);
+}
+
+// 设置所有像素颜色
+esp_err_t ws2812b_set_all_pixels(ws2812b_color_t color)
+{
+    WS2812B_CHECK_DEFAULT_STRIP();
+    return ws2812b_strip_set_all_pixels(default_strip, color);
+}
+
+// 清除所有LED
+esp_err_t ws2812b_clear(void)
+{
+    return ws2812b_set_all_pixels((ws2812b_color_t)WS2812B_COLOR_BLACK);
+}
+
+// 刷新LED显示（阻塞直到发送完成）
+esp_err_t ws2812b_refresh(void)
+{
+    WS2812B_CHECK_DEFAULT_STRIP();
+    return ws2812b_strip_refresh(default_strip);
+}
+
+// 异步刷新LED显示
+esp_err_t ws2812b_refresh_async(void)
+{
+    WS2812B_CHECK_DEFAULT_STRIP();
+    return ws2812b_strip_refresh_async(default_strip);
+}
+
+// 等待所有已提交的帧发送完成
+esp_err_t ws2812b_wait_refresh_done(int timeout_ms)
+{
+    WS2812B_CHECK_DEFAULT_STRIP();
+    return ws2812b_strip_wait_refresh_done(default_strip, timeout_ms);
+}
+
+// 获取尚未发送完成的帧数
+uint32_t ws2812b_get_pending_frames(void)
+{
+    return ws2812b_strip_get_pending_frames(default_strip);
+}
+
+// 注册发送完成回调
+esp_err_t ws2812b_register_done_callback(ws2812b_done_callback_t callback, void *user_ctx)
+{
+    WS2812B_CHECK_DEFAULT_STRIP();
+    return ws2812b_strip_register_done_callback(default_strip, callback, user_ctx);
+}
+
+// 设置默认灯带亮度
+esp_err_t ws2812b_set_brightness(uint8_t brightness)
+{
+    WS2812B_CHECK_DEFAULT_STRIP();
+    return ws2812b_strip_set_brightness(default_strip, brightness);
+}
+
 // 反初始化驱动
 esp_err_t ws2812b_deinit(void)
 {
-    if (!driver_initialized) {
+    if (!default_strip) {
         return ESP_OK;
     }
     
     ESP_LOGI(TAG, "反初始化WS2812B驱动");
     
-    if (tx_chan) {
-        rmt_disable(tx_chan);
-        rmt_del_channel(tx_chan);
-        tx_chan = NULL;
-    }
+    ws2812b_strip_del(default_strip);
+    default_strip = NULL;
     
-    driver_initialized = false;
     ESP_LOGI(TAG, "WS2812B驱动反初始化完成");
     
     return ESP_OK;
@@ -179,7 +933,7 @@ esp_err_t ws2812b_deinit(void)
 // 测试基本颜色
 void ws2812b_test_basic_colors(void)
 {
-    if (!driver_initialized) {
+    if (!default_strip) {
         ESP_LOGE(TAG, "驱动未初始化，无法测试");
         return;
     }
@@ -218,120 +972,203 @@ void ws2812b_test_basic_colors(void)
     ESP_LOGI(TAG, "基本颜色测试完成");
 }
 
-// 测试彩虹效果
-void ws2812b_test_rainbow(void)
+// 测试刷新性能：统计每帧刷新耗时及堆内存变化
+void ws2812b_test_refresh_perf(uint32_t frames)
 {
-    if (!driver_initialized) {
+    if (!default_strip) {
         ESP_LOGE(TAG, "驱动未初始化，无法测试");
         return;
     }
     
-    ESP_LOGI(TAG, "开始彩虹效果测试");
-    
-    for (int i = 0; i < 256; i++) {
-        // 生成彩虹颜色
-        uint8_t r, g, b;
-        if (i < 85) {
-            r = 255 - i * 3;
-            g = i * 3;
-            b = 0;
-        } else if (i < 170) {
-            i -= 85;
-            r = 0;
-            g = 255 - i * 3;
-            b = i * 3;
-        } else {
-            i -= 170;
-            r = i * 3;
-            g = 0;
-            b = 255 - i * 3;
-        }
+    if (frames == 0) {
+        frames = 100;
+    }
+    
+    ESP_LOGI(TAG, "开始刷新性能测试，帧数: %lu", (unsigned long)frames);
+    
+    uint32_t heap_before = esp_get_free_heap_size();
+    int64_t total_us = 0;
+    int64_t max_us = 0;
+    
+    for (uint32_t i = 0; i < frames; i++) {
+        ws2812b_set_all_pixels((ws2812b_color_t){i & 0xFF, 0, 0, 0});
         
-        ws2812b_set_all_pixels((ws2812b_color_t){r, g, b});
+        int64_t start = esp_timer_get_time();
         ws2812b_refresh();
-        vTaskDelay(pdMS_TO_TICKS(50));
+        int64_t cost = esp_timer_get_time() - start;
+        
+        total_us += cost;
+        if (cost > max_us) {
+            max_us = cost;
+        }
     }
     
+    uint32_t heap_after = esp_get_free_heap_size();
+    
     ws2812b_clear();
     ws2812b_refresh();
-    ESP_LOGI(TAG, "彩虹效果测试完成");
+    
+    ESP_LOGI(TAG, "刷新性能: 平均 %lld us/帧, 最大 %lld us/帧, 堆内存变化 %ld bytes",
+             (long long)(total_us / frames), (long long)max_us,
+             (long)heap_after - (long)heap_before);
 }
 
-// 测试渐变效果
-void ws2812b_test_fade(void)
+// 流式发送压力测试：连续全速刷新长灯带（建议在WiFi收发期间运行），统计欠载次数
+void ws2812b_test_stream_stress(ws2812b_strip_t *strip, uint32_t frames)
 {
-    if (!driver_initialized) {
-        ESP_LOGE(TAG, "驱动未初始化，无法测试");
+    if (!strip) {
+        ESP_LOGE(TAG, "灯带为空，无法测试");
         return;
     }
     
-    ESP_LOGI(TAG, "开始渐变效果测试");
+    uint16_t led_count = ws2812b_strip_get_led_count(strip);
+    ws2812b_strip_stats_t before, after;
+    ws2812b_strip_get_stats(strip, &before);
     
-    // 红色渐变
-    for (int i = 0; i <= 255; i++) {
-        ws2812b_set_all_pixels((ws2812b_color_t){i, 0, 0});
-        ws2812b_refresh();
-        vTaskDelay(pdMS_TO_TICKS(20));
-    }
+    ESP_LOGI(TAG, "开始流式发送压力测试，LED数量: %d，帧数: %lu", led_count, (unsigned long)frames);
     
-    for (int i = 255; i >= 0; i--) {
-        ws2812b_set_all_pixels((ws2812b_color_t){i, 0, 0});
-        ws2812b_refresh();
-        vTaskDelay(pdMS_TO_TICKS(20));
-    }
+    int64_t start = esp_timer_get_time();
+    int64_t max_frame_us = 0;
     
-    // 绿色渐变
-    for (int i = 0; i <= 255; i++) {
-        ws2812b_set_all_pixels((ws2812b_color_t){0, i, 0});
-        ws2812b_refresh();
-        vTaskDelay(pdMS_TO_TICKS(20));
+    for (uint32_t i = 0; i < frames; i++) {
+        // 每帧移动一个像素的渐变图案，保证每个字节都在变化
+        for (uint16_t p = 0; p < led_count; p++) {
+            uint8_t v = (uint8_t)(p + i);
+            ws2812b_strip_set_pixel(strip, p, (ws2812b_color_t){v, (uint8_t)(255 - v), (uint8_t)(v ^ 0x55), 0});
+        }
+        ws2812b_strip_refresh_async(strip);
+        
+        ws2812b_strip_stats_t stats;
+        ws2812b_strip_get_stats(strip, &stats);
+        if (stats.last_frame_us > max_frame_us) {
+            max_frame_us = stats.last_frame_us;
+        }
     }
+    ws2812b_strip_wait_refresh_done(strip, WS2812B_TIMEOUT_MS);
     
-    for (int i = 255; i >= 0; i--) {
-        ws2812b_set_all_pixels((ws2812b_color_t){0, i, 0});
-        ws2812b_refresh();
-        vTaskDelay(pdMS_TO_TICKS(20));
+    int64_t elapsed = esp_timer_get_time() - start;
+    ws2812b_strip_get_stats(strip, &after);
+    
+    ESP_LOGI(TAG, "流式发送压力测试完成: %lu帧, %lld ms, 最长帧 %lld us, 欠载 %lu 次",
+             (unsigned long)(after.frames_done - before.frames_done), (long long)(elapsed / 1000),
+             (long long)max_frame_us, (unsigned long)(after.late_refills - before.late_refills));
+    
+    ws2812b_strip_clear(strip);
+    ws2812b_strip_refresh(strip);
+}
+
+// 抖动渐变测试：在最低约3%亮度范围内按16位步进渐变，全速刷新以便抖动平均
+// 需要以flags.dithering = 1创建的灯带，同时统计每帧量化耗时
+void ws2812b_test_dither_fade(ws2812b_strip_t *strip)
+{
+    if (!strip || !strip->hd_buffer) {
+        ESP_LOGE(TAG, "灯带未启用抖动模式，无法测试");
+        return;
     }
     
-    // 蓝色渐变
-    for (int i = 0; i <= 255; i++) {
-        ws2812b_set_all_pixels((ws2812b_color_t){0, 0, i});
-        ws2812b_refresh();
-        vTaskDelay(pdMS_TO_TICKS(20));
+    const uint16_t max_level = 0x0800;    // 8位下约8级，不抖动时台阶明显
+    const int64_t duration_us = 2000000;
+    int64_t start = esp_timer_get_time();
+    int64_t now = start;
+    int64_t dither_us = 0;
+    int64_t max_dither_us = 0;
+    uint32_t frames = 0;
+    
+    ESP_LOGI(TAG, "开始抖动渐变测试，LED数量: %d", strip->led_count);
+    
+    while ((now = esp_timer_get_time()) - start < duration_us) {
+        // 前一半时间渐亮，后一半时间渐暗
+        int64_t t = now - start;
+        int64_t half = duration_us / 2;
+        uint16_t level = (uint16_t)((t < half ? t : duration_us - t) * max_level / half);
+        
+        for (uint16_t p = 0; p < strip->led_count; p++) {
+            strip->hd_buffer[p] = (ws2812b_color16_t){level, level, level};
+        }
+        
+        int64_t t0 = esp_timer_get_time();
+        ws2812b_prepare_frame(strip);
+        int64_t cost = esp_timer_get_time() - t0;
+        dither_us += cost;
+        if (cost > max_dither_us) {
+            max_dither_us = cost;
+        }
+        
+        // 已量化到后台缓冲区，直接交换发送
+        if (strip->backend->wait_done(strip->backend, WS2812B_TIMEOUT_MS) != ESP_OK ||
+            ws2812b_swap_and_transmit(strip, (size_t)strip->led_count * strip->bytes_per_pixel, true) != ESP_OK) {
+            break;
+        }
+        frames++;
     }
+    ws2812b_strip_wait_refresh_done(strip, WS2812B_TIMEOUT_MS);
     
-    for (int i = 255; i >= 0; i--) {
-        ws2812b_set_all_pixels((ws2812b_color_t){0, 0, i});
-        ws2812b_refresh();
-        vTaskDelay(pdMS_TO_TICKS(20));
+    if (frames > 0) {
+        ESP_LOGI(TAG, "抖动渐变测试完成: %lu帧, 平均 %lld fps, 量化平均 %lld us/帧, 最大 %lld us/帧",
+                 (unsigned long)frames, (long long)(frames * 1000000LL / (now - start)),
+                 (long long)(dither_us / frames), (long long)max_dither_us);
     }
     
-    ws2812b_clear();
-    ws2812b_refresh();
-    ESP_LOGI(TAG, "渐变效果测试完成");
+    ws2812b_strip_clear(strip);
+    ws2812b_strip_refresh(strip);
 }
 
-// 测试闪烁效果
-void ws2812b_test_blink(void)
+// 跳过未变化帧自检：静态画面重复刷新应全部跳过，只改一个像素时只发送到该像素为止
+// 会改写灯带内容，结束时清空
+bool ws2812b_test_skip_unchanged(ws2812b_strip_t *strip)
 {
-    if (!driver_initialized) {
-        ESP_LOGE(TAG, "驱动未初始化，无法测试");
-        return;
+    if (!strip) {
+        ESP_LOGE(TAG, "灯带为空，无法测试");
+        return false;
     }
     
-    ESP_LOGI(TAG, "开始闪烁效果测试");
+#if WS2812B_SKIP_UNCHANGED
+    const uint32_t repeats = 20;
+    ws2812b_strip_stats_t before, after;
+    bool passed = true;
     
-    for (int i = 0; i < 10; i++) {
-        // 开启
-        ws2812b_set_all_pixels((ws2812b_color_t)WS2812B_COLOR_WHITE);
-        ws2812b_refresh();
-        vTaskDelay(pdMS_TO_TICKS(200));
-        
-        // 关闭
-        ws2812b_clear();
-        ws2812b_refresh();
-        vTaskDelay(pdMS_TO_TICKS(200));
+    ESP_LOGI(TAG, "开始跳过未变化帧自检，LED数量: %d", strip->led_count);
+    
+    // 先刷新两帧，让抖动模式的量化误差稳定下来
+    for (int i = 0; i < 2; i++) {
+        ws2812b_strip_set_all_pixels(strip, (ws2812b_color_t)WS2812B_COLOR_BLUE);
+        ws2812b_strip_refresh(strip);
     }
+    ws2812b_strip_get_stats(strip, &before);
+    
+    // 静态画面：重复写入相同颜色后刷新，全部应被跳过
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < repeats; i++) {
+        ws2812b_strip_set_all_pixels(strip, (ws2812b_color_t)WS2812B_COLOR_BLUE);
+        ws2812b_strip_refresh(strip);
+    }
+    int64_t skip_us = (esp_timer_get_time() - start) / repeats;
+    ws2812b_strip_get_stats(strip, &after);
+    if (after.frames_skipped - before.frames_skipped != repeats || after.frames_done != before.frames_done) {
+        ESP_LOGE(TAG, "静态画面未被跳过: 跳过 %lu/%lu",
+                 (unsigned long)(after.frames_skipped - before.frames_skipped), (unsigned long)repeats);
+        passed = false;
+    }
+    
+    // 只改第一个像素：应发送且只发送第一个像素（抖动模式整帧比较，整帧发送）
+    ws2812b_strip_set_pixel(strip, 0, (ws2812b_color_t)WS2812B_COLOR_RED);
+    ws2812b_prepare_frame(strip);
+    if (!strip->hd_buffer && ws2812b_frame_tx_size(strip) != strip->bytes_per_pixel) {
+        ESP_LOGE(TAG, "部分更新的发送长度错误");
+        passed = false;
+    }
+    start = esp_timer_get_time();
+    ws2812b_strip_refresh(strip);
+    int64_t partial_us = esp_timer_get_time() - start;
+    
+    ESP_LOGI(TAG, "刷新耗时: 跳过 %lld us/次，只发送1个像素 %lld us", (long long)skip_us, (long long)partial_us);
+    ESP_LOGI(TAG, "跳过未变化帧自检%s", passed ? "通过" : "失败");
     
-    ESP_LOGI(TAG, "闪烁效果测试完成");
+    ws2812b_strip_clear(strip);
+    ws2812b_strip_refresh(strip);
+    return passed;
+#else
+    ESP_LOGW(TAG, "WS2812B_SKIP_UNCHANGED未启用，跳过自检");
+    return true;
+#endif
 }
@@ -4,54 +4,169 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "driver/rmt_tx.h"
+#include "driver/spi_master.h"
 #include "driver/gpio.h"
 #include "esp_err.h"
+#include "ws2812b_config.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// WS2812B配置参数
-#define WS2812B_LED_COUNT          1       // LED数量（您只有一个灯）
-#define WS2812B_RMT_RESOLUTION_HZ  10000000 // RMT分辨率：10MHz
-#define WS2812B_T0H_NS            350      // T0H时间：350ns
-#define WS2812B_T0L_NS            800      // T0L时间：800ns
-#define WS2812B_T1H_NS            700      // T1H时间：700ns
-#define WS2812B_T1L_NS            600      // T1L时间：600ns
-#define WS2812B_RESET_TIME_US      280      // 复位时间：280us
+// WS2812B配置参数见ws2812b_config.h
 
 // 颜色结构体
 typedef struct {
     uint8_t red;
     uint8_t green;
     uint8_t blue;
+    uint8_t white;      // RGBW芯片（如SK6812 RGBW）的白色通道，RGB芯片忽略
 } ws2812b_color_t;
 
+// 16位颜色结构体（抖动模式使用，0-65535）
+typedef struct {
+    uint16_t red;
+    uint16_t green;
+    uint16_t blue;
+} ws2812b_color16_t;
+
+// 颜色顺序（线上字节发送顺序）
+typedef enum {
+    WS2812B_ORDER_GRB = 0,  // WS2812B标准顺序
+    WS2812B_ORDER_RGB,
+    WS2812B_ORDER_BRG,
+    WS2812B_ORDER_RBG,
+    WS2812B_ORDER_GBR,
+    WS2812B_ORDER_BGR,
+    WS2812B_ORDER_MAX,
+} ws2812b_color_order_t;
+
+// 发送后端
+typedef enum {
+    WS2812B_BACKEND_RMT = 0,    // RMT外设（默认）
+    WS2812B_BACKEND_SPI,        // SPI外设+DMA：每个WS2812B位展开为3个SPI位，不占用RMT通道
+} ws2812b_backend_type_t;
+
+// 芯片配置：时序、每像素字节数和线上颜色顺序
+// 可以按同样的格式定义其他兼容芯片，创建灯带时传入
+typedef struct {
+    const char *name;                   // 芯片名称
+    uint16_t t0h_ns;                    // 0码高电平时间（纳秒）
+    uint16_t t0l_ns;                    // 0码低电平时间（纳秒）
+    uint16_t t1h_ns;                    // 1码高电平时间（纳秒）
+    uint16_t t1l_ns;                    // 1码低电平时间（纳秒）
+    uint16_t reset_us;                  // 复位时间（微秒）
+    uint8_t bytes_per_pixel;            // 每像素字节数：3=RGB，4=RGBW
+    ws2812b_color_order_t color_order;  // RGB部分的线上顺序，RGBW芯片的白色字节固定在最后
+} ws2812b_chip_t;
+
+// 预定义芯片
+extern const ws2812b_chip_t ws2812b_chip_ws2812b;       // WS2812B，时序见ws2812b_config.h
+extern const ws2812b_chip_t ws2812b_chip_sk6812_rgbw;   // SK6812 RGBW，GRBW顺序
+extern const ws2812b_chip_t ws2812b_chip_ws2815;        // WS2815（12V），GRB顺序
+
+// 发送完成回调（在RMT中断上下文中调用，返回值表示是否唤醒了更高优先级任务）
+typedef bool (*ws2812b_done_callback_t)(void *user_ctx);
+
+// 灯带对象（不透明句柄）
+typedef struct ws2812b_strip_t ws2812b_strip_t;
+
+// 灯带配置
+typedef struct {
+    gpio_num_t gpio_num;                // 数据引脚
+    uint16_t led_count;                 // LED数量（运行时指定）
+    ws2812b_color_order_t color_order;  // 像素格式（线上颜色顺序），chip不为NULL时使用芯片配置中的顺序
+    const ws2812b_chip_t *chip;         // 可选：芯片配置，NULL表示WS2812B
+    ws2812b_backend_type_t backend;     // 发送后端，创建时选定
+    spi_host_device_t spi_host;         // SPI后端使用的SPI主机（如SPI2_HOST）
+    void *buffer;                       // 可选：调用者提供的帧缓冲区，大小为WS2812B_STRIP_BUFFER_SIZE(led_count)
+                                        // （RGBW芯片为WS2812B_STRIP_BUFFER_SIZE_BPP(led_count, 4)）；
+                                        // 为NULL时按实际LED数量在堆上分配
+    size_t mem_block_symbols;           // 可选：RMT内存块符号数，0表示使用默认值
+    struct {
+        uint32_t streaming: 1;          // RMT流式模式：用于1000+个LED的长灯带，占用最大RMT内存（或DMA）并提高中断优先级
+        uint32_t dithering: 1;          // 时间抖动模式：像素按16位保存，发送前量化为8位并把误差带到下一帧
+        uint32_t packed: 1;             // 紧凑模式：缓冲区按线上顺序保存已应用亮度的字节，发送时不做转换
+                                        // （修改亮度只影响之后写入的像素）
+    } flags;
+} ws2812b_strip_config_t;
+
+// 灯带帧缓冲区大小（前/后台两帧，每像素bytes_per_pixel字节）
+#define WS2812B_STRIP_BUFFER_SIZE_BPP(led_count, bytes_per_pixel)  (2 * (size_t)(led_count) * (bytes_per_pixel))
+#define WS2812B_STRIP_BUFFER_SIZE(led_count)  WS2812B_STRIP_BUFFER_SIZE_BPP(led_count, 3)
+
+// 灯带发送统计
+typedef struct {
+    uint32_t frames_done;               // 已发送完成的帧数
+    int64_t last_frame_us;              // 上一帧从提交到发送完成的耗时（微秒）
+    uint32_t late_refills;              // RMT内存补充过晚（欠载）的次数，出现时灯带可能闪烁
+    uint32_t frames_skipped;            // 帧内容未变化而跳过的刷新次数
+} ws2812b_strip_stats_t;
+
 // 预定义颜色
-#define WS2812B_COLOR_RED      {255, 0, 0}
-#define WS2812B_COLOR_GREEN    {0, 255, 0}
-#define WS2812B_COLOR_BLUE     {0, 0, 255}
-#define WS2812B_COLOR_WHITE    {255, 255, 255}
-#define WS2812B_COLOR_BLACK    {0, 0, 0}
-#define WS2812B_COLOR_YELLOW   {255, 255, 0}
-#define WS2812B_COLOR_CYAN     {0, 255, 255}
-#define WS2812B_COLOR_MAGENTA  {255, 0, 255}
-#define WS2812B_COLOR_ORANGE   {255, 165, 0}
-#define WS2812B_COLOR_PURPLE   {128, 0, 128}
-
-// 函数声明
+#define WS2812B_COLOR_RED      {255, 0, 0, 0}
+#define WS2812B_COLOR_GREEN    {0, 255, 0, 0}
+#define WS2812B_COLOR_BLUE     {0, 0, 255, 0}
+#define WS2812B_COLOR_WHITE    {255, 255, 255, 0}
+#define WS2812B_COLOR_BLACK    {0, 0, 0, 0}
+#define WS2812B_COLOR_YELLOW   {255, 255, 0, 0}
+#define WS2812B_COLOR_CYAN     {0, 255, 255, 0}
+#define WS2812B_COLOR_MAGENTA  {255, 0, 255, 0}
+#define WS2812B_COLOR_ORANGE   {255, 165, 0, 0}
+#define WS2812B_COLOR_PURPLE   {128, 0, 128, 0}
+
+// 灯带接口
+esp_err_t ws2812b_strip_new(const ws2812b_strip_config_t *config, ws2812b_strip_t **ret_strip);
+esp_err_t ws2812b_strip_del(ws2812b_strip_t *strip);
+uint16_t ws2812b_strip_get_led_count(const ws2812b_strip_t *strip);
+uint8_t ws2812b_strip_get_bytes_per_pixel(const ws2812b_strip_t *strip);
+uint32_t ws2812b_strip_get_frame_time_us(const ws2812b_strip_t *strip);
+uint32_t ws2812b_strip_get_max_fps(const ws2812b_strip_t *strip);
+esp_err_t ws2812b_strip_set_pixel(ws2812b_strip_t *strip, uint16_t pixel_index, ws2812b_color_t color);
+esp_err_t ws2812b_strip_set_all_pixels(ws2812b_strip_t *strip, ws2812b_color_t color);
+esp_err_t ws2812b_strip_set_pixel16(ws2812b_strip_t *strip, uint16_t pixel_index, ws2812b_color16_t color);
+esp_err_t ws2812b_strip_fill(ws2812b_strip_t *strip, uint16_t start, uint16_t count, ws2812b_color_t color);
+esp_err_t ws2812b_strip_set_pixels(ws2812b_strip_t *strip, uint16_t start,
+                                   const ws2812b_color_t *colors, uint16_t count);
+esp_err_t ws2812b_strip_write_raw(ws2812b_strip_t *strip, uint16_t start, const void *data, uint16_t count);
+esp_err_t ws2812b_strip_write_channels(ws2812b_strip_t *strip, uint16_t start, const uint8_t *data, uint16_t count);
+esp_err_t ws2812b_strip_clear(ws2812b_strip_t *strip);
+esp_err_t ws2812b_strip_refresh(ws2812b_strip_t *strip);
+esp_err_t ws2812b_strip_refresh_async(ws2812b_strip_t *strip);
+esp_err_t ws2812b_strip_wait_refresh_done(ws2812b_strip_t *strip, int timeout_ms);
+esp_err_t ws2812b_strip_invalidate(ws2812b_strip_t *strip);
+uint32_t ws2812b_strip_get_pending_frames(const ws2812b_strip_t *strip);
+esp_err_t ws2812b_strip_get_stats(ws2812b_strip_t *strip, ws2812b_strip_stats_t *stats);
+esp_err_t ws2812b_strip_register_done_callback(ws2812b_strip_t *strip,
+                                               ws2812b_done_callback_t callback, void *user_ctx);
+esp_err_t ws2812b_strip_set_brightness(ws2812b_strip_t *strip, uint8_t brightness);
+uint8_t ws2812b_strip_get_brightness(const ws2812b_strip_t *strip);
+esp_err_t ws2812b_strip_set_gamma(ws2812b_strip_t *strip, bool enable);
+
+// 多灯带接口：所有已创建的灯带同时发送
+esp_err_t ws2812b_refresh_all(void);
+esp_err_t ws2812b_refresh_all_async(void);
+
+// 兼容接口：操作ws2812b_init()创建的默认灯带（WS2812B_LED_COUNT个LED）
 esp_err_t ws2812b_init(gpio_num_t gpio_num);
+ws2812b_strip_t *ws2812b_get_default_strip(void);
 esp_err_t ws2812b_set_pixel(uint16_t pixel_index, ws2812b_color_t color);
 esp_err_t ws2812b_set_all_pixels(ws2812b_color_t color);
 esp_err_t ws2812b_clear(void);
 esp_err_t ws2812b_refresh(void);
+esp_err_t ws2812b_refresh_async(void);
+esp_err_t ws2812b_wait_refresh_done(int timeout_ms);
+uint32_t ws2812b_get_pending_frames(void);
+esp_err_t ws2812b_register_done_callback(ws2812b_done_callback_t callback, void *user_ctx);
+esp_err_t ws2812b_set_brightness(uint8_t brightness);
 esp_err_t ws2812b_deinit(void);
 
 // 测试函数
 void ws2812b_test_basic_colors(void);
-void ws2812b_test_rainbow(void);
-void ws2812b_test_fade(void);
-void ws2812b_test_blink(void);
+void ws2812b_test_refresh_perf(uint32_t frames);
+void ws2812b_test_stream_stress(ws2812b_strip_t *strip, uint32_t frames);
+void ws2812b_test_dither_fade(ws2812b_strip_t *strip);
+bool ws2812b_test_skip_unchanged(ws2812b_strip_t *strip);
 
 #ifdef __cplusplus
 }
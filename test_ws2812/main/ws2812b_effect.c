@@ -0,0 +1,416 @@
+#include "ws2812b_effect.h"
+#include "ws2812b_color.h"
+#include "ws2812b_tribuf.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include <string.h>
+#include <stdatomic.h>
+
+static const char *TAG = "WS2812B_EFFECT";
+
+// 效果引擎（全局唯一，驱动一条灯带）
+static struct {
+    ws2812b_effect_t effects[WS2812B_EFFECT_MAX];   // 已注册的效果
+    int effect_count;
+    volatile int requested;                         // 请求切换到的效果，-1表示不渲染
+    volatile int current;                           // 渲染任务正在运行的效果
+    atomic_int requested_brightness;                // 请求设置的亮度，-1表示没有请求；取用时原子交换，不会丢掉取用期间的新请求
+    ws2812b_effect_palette_t palettes[3];           // 调色板三缓冲，由ws2812b_effect_set_palette()写入
+    ws2812b_tribuf_t palette_buf;
+    ws2812b_strip_t *strip;
+    uint32_t fps;                                   // 目标帧率
+    uint32_t period_us;                             // 帧周期
+    esp_timer_handle_t timer;                       // 帧定时器，按帧周期唤醒渲染任务
+    TaskHandle_t task;
+    TaskHandle_t stop_waiter;                       // 等待渲染任务退出的任务
+    volatile bool running;
+    ws2812b_effect_stats_t stats;
+    portMUX_TYPE lock;
+} s_engine = {
+    .requested = -1,
+    .current = -1,
+    .requested_brightness = -1,
+    .palette_buf = WS2812B_TRIBUF_INIT,
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+// ============================================================================
+// 内置效果：全部按经过时间计算，速度沿用ws2812b_config.h中原测试函数的步进间隔
+// ============================================================================
+
+// 彩虹：每WS2812B_RAINBOW_DELAY_MS前进1/256圈色相，灯带上铺满一整圈
+// 色相按16位计算，帧率高于步进速度时颜色也连续变化
+static void ws2812b_effect_rainbow(ws2812b_strip_t *strip, const ws2812b_effect_frame_t *frame, void *user_ctx)
+{
+    uint16_t led_count = ws2812b_strip_get_led_count(strip);
+    uint16_t hue = (uint16_t)(frame->elapsed_us * 256 / (WS2812B_RAINBOW_DELAY_MS * 1000));
+    
+    for (uint16_t p = 0; p < led_count; p++) {
+        uint16_t pixel_hue = hue + (uint16_t)((uint32_t)p * 65536 / led_count);
+        ws2812b_strip_set_pixel(strip, p, ws2812b_color_from_hsv(pixel_hue, 255, 255));
+    }
+}
+
+// 渐变：红、绿、蓝依次从0渐亮到255再渐暗，每WS2812B_FADE_DELAY_MS一级
+static void ws2812b_effect_fade(ws2812b_strip_t *strip, const ws2812b_effect_frame_t *frame, void *user_ctx)
+{
+    uint32_t step = (uint32_t)(frame->elapsed_us / (WS2812B_FADE_DELAY_MS * 1000)) % (512 * 3);
+    uint32_t phase = step % 512;
+    uint8_t level = phase < 256 ? phase : 511 - phase;
+    ws2812b_color_t color = WS2812B_COLOR_BLACK;
+    
+    switch (step / 512) {
+    case 0: color.red = level; break;
+    case 1: color.green = level; break;
+    default: color.blue = level; break;
+    }
+    ws2812b_strip_set_all_pixels(strip, color);
+}
+
+// 闪烁：白色亮/灭各WS2812B_BLINK_DELAY_MS
+static void ws2812b_effect_blink(ws2812b_strip_t *strip, const ws2812b_effect_frame_t *frame, void *user_ctx)
+{
+    bool on = (frame->elapsed_us / (WS2812B_BLINK_DELAY_MS * 1000)) % 2 == 0;
+    ws2812b_strip_set_all_pixels(strip, on ? (ws2812b_color_t)WS2812B_COLOR_WHITE
+                                           : (ws2812b_color_t)WS2812B_COLOR_BLACK);
+}
+
+// 呼吸灯：红、绿、蓝依次呼吸，每WS2812B_BREATH_DELAY_MS变化WS2812B_BREATH_STEP
+static void ws2812b_effect_breath(ws2812b_strip_t *strip, const ws2812b_effect_frame_t *frame, void *user_ctx)
+{
+    const uint32_t half = (255 + WS2812B_BREATH_STEP - 1) / WS2812B_BREATH_STEP;
+    uint32_t step = (uint32_t)(frame->elapsed_us / (WS2812B_BREATH_DELAY_MS * 1000)) % (half * 2 * 3);
+    uint32_t phase = step % (half * 2);
+    uint32_t level = (phase < half ? phase : half * 2 - phase) * WS2812B_BREATH_STEP;
+    ws2812b_color_t color = WS2812B_COLOR_BLACK;
+    
+    if (level > 255) {
+        level = 255;
+    }
+    switch (step / (half * 2)) {
+    case 0: color.red = level; break;
+    case 1: color.green = level; break;
+    default: color.blue = level; break;
+    }
+    ws2812b_strip_set_all_pixels(strip, color);
+}
+
+// 调色板：颜色沿灯带均匀铺开、相邻颜色之间插值，整体转动速度与彩虹相同
+// 调色板在帧开始时由渲染任务取用，ws2812b_effect_set_palette()之前使用红、绿、蓝
+static void ws2812b_effect_palette(ws2812b_strip_t *strip, const ws2812b_effect_frame_t *frame, void *user_ctx)
+{
+    static const ws2812b_effect_palette_t default_palette = {
+        .colors = {WS2812B_COLOR_RED, WS2812B_COLOR_GREEN, WS2812B_COLOR_BLUE},
+        .count = 3,
+    };
+    const ws2812b_effect_palette_t *palette = &s_engine.palettes[s_engine.palette_buf.read];
+    uint16_t led_count = ws2812b_strip_get_led_count(strip);
+    uint16_t offset = (uint16_t)(frame->elapsed_us * 256 / (WS2812B_RAINBOW_DELAY_MS * 1000));
+    
+    if (palette->count == 0) {
+        palette = &default_palette;
+    }
+    for (uint16_t p = 0; p < led_count; p++) {
+        uint16_t position = offset + (uint16_t)((uint32_t)p * 65536 / led_count);
+        uint32_t scaled = (uint32_t)position * palette->count;
+        uint8_t index = scaled >> 16;
+        uint8_t next = index + 1 < palette->count ? index + 1 : 0;
+        ws2812b_strip_set_pixel(strip, p, ws2812b_color_blend(palette->colors[index], palette->colors[next],
+                                                              (scaled >> 8) & 0xFF));
+    }
+}
+
+static const ws2812b_effect_t ws2812b_builtin_effects[] = {
+    {WS2812B_EFFECT_RAINBOW, ws2812b_effect_rainbow, NULL},
+    {WS2812B_EFFECT_FADE,    ws2812b_effect_fade,    NULL},
+    {WS2812B_EFFECT_BLINK,   ws2812b_effect_blink,   NULL},
+    {WS2812B_EFFECT_BREATH,  ws2812b_effect_breath,  NULL},
+    {WS2812B_EFFECT_PALETTE, ws2812b_effect_palette, NULL},
+};
+
+// ============================================================================
+// 效果引擎
+// ============================================================================
+
+// 按名称查找效果，返回序号，未找到返回-1
+static int ws2812b_effect_find(const char *name)
+{
+    for (int i = 0; i < s_engine.effect_count; i++) {
+        if (strcmp(s_engine.effects[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 注册效果（名称不能重复）
+esp_err_t ws2812b_effect_register(const ws2812b_effect_t *effect)
+{
+    ESP_RETURN_ON_FALSE(effect && effect->name && effect->render, ESP_ERR_INVALID_ARG, TAG, "效果参数无效");
+    
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&s_engine.lock);
+    if (ws2812b_effect_find(effect->name) >= 0) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else if (s_engine.effect_count >= WS2812B_EFFECT_MAX) {
+        ret = ESP_ERR_NO_MEM;
+    } else {
+        s_engine.effects[s_engine.effect_count++] = *effect;
+    }
+    portEXIT_CRITICAL(&s_engine.lock);
+    
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "注册效果失败: %s (%s)", effect->name, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+// 注册内置效果（只执行一次）
+static void ws2812b_effect_register_builtins(void)
+{
+    for (size_t i = 0; i < sizeof(ws2812b_builtin_effects) / sizeof(ws2812b_builtin_effects[0]); i++) {
+        if (ws2812b_effect_find(ws2812b_builtin_effects[i].name) < 0) {
+            ws2812b_effect_register(&ws2812b_builtin_effects[i]);
+        }
+    }
+}
+
+// 帧定时器回调：唤醒渲染任务开始下一帧
+static void ws2812b_effect_timer_cb(void *arg)
+{
+    xTaskNotifyGive(s_engine.task);
+}
+
+// 渲染任务：每个帧周期渲染当前效果并异步提交，渲染下一帧与本帧发送重叠
+// 帧周期由esp_timer定时器驱动（微秒精度，不受FreeRTOS节拍限制），第n帧的调度时刻固定为启动时刻+n个周期
+static void ws2812b_effect_task(void *arg)
+{
+    const uint32_t period_us = s_engine.period_us;
+    int current = -1;
+    uint64_t tick = 0;                  // 自启动以来的帧周期数
+    uint64_t effect_tick = 0;           // 当前效果开始时的帧周期数
+    int64_t window_start = esp_timer_get_time();
+    uint32_t window_frames = 0;
+    int64_t window_render_us = 0;
+    int64_t window_jitter_us = 0;
+    
+    ESP_LOGI(TAG, "渲染任务启动，目标帧率: %lu fps（帧周期 %lu us，灯带最高 %lu fps）",
+             (unsigned long)s_engine.fps, (unsigned long)period_us,
+             (unsigned long)ws2812b_strip_get_max_fps(s_engine.strip));
+    
+    int64_t schedule_start = esp_timer_get_time();
+    esp_timer_start_periodic(s_engine.timer, period_us);
+    
+    while (s_engine.running) {
+        // 等待帧定时器
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!s_engine.running) {
+            break;
+        }
+        // 帧周期数按实际时间计算：定时器开启了skip_unhandled_events，上一帧超时时错过的周期不会再通知，
+        // 只数通知次数会让tick和elapsed_us落后于实际时间；due大于1说明中间的帧周期被跳过
+        int64_t frame_start = esp_timer_get_time();
+        uint64_t now_tick = (uint64_t)(frame_start - schedule_start) / period_us;
+        uint32_t due = now_tick > tick ? (uint32_t)(now_tick - tick) : 1;
+        tick += due;
+        int64_t scheduled = schedule_start + (int64_t)(tick * period_us);
+        int64_t jitter_us = frame_start - scheduled;
+        
+        // 亮度和调色板的修改在帧边界取用，其他任务只写请求，不直接操作灯带
+        int brightness = atomic_exchange(&s_engine.requested_brightness, -1);
+        if (brightness >= 0) {
+            ws2812b_strip_set_brightness(s_engine.strip, (uint8_t)brightness);
+        }
+        ws2812b_tribuf_acquire(&s_engine.palette_buf);
+        
+        // 切换效果在帧边界生效，新效果从0开始计时
+        int requested = s_engine.requested;
+        if (requested != current) {
+            current = requested;
+            effect_tick = tick;
+            s_engine.current = current;
+            if (current < 0) {
+                ws2812b_strip_clear(s_engine.strip);
+                ws2812b_strip_refresh_async(s_engine.strip);
+            }
+        }
+        
+        if (current >= 0) {
+            const ws2812b_effect_t *effect = &s_engine.effects[current];
+            ws2812b_effect_frame_t frame = {
+                .index = (uint32_t)(tick - effect_tick),
+                .elapsed_us = (int64_t)((tick - effect_tick) * period_us),
+                .deadline_us = scheduled + period_us,
+                .period_us = period_us,
+            };
+            effect->render(s_engine.strip, &frame, effect->user_ctx);
+            int64_t render_us = esp_timer_get_time() - frame_start;
+            
+            ws2812b_strip_refresh_async(s_engine.strip);
+            bool missed = esp_timer_get_time() > frame.deadline_us;
+            
+            window_frames++;
+            window_render_us += render_us;
+            window_jitter_us += jitter_us;
+            
+            portENTER_CRITICAL(&s_engine.lock);
+            s_engine.stats.frames++;
+            s_engine.stats.dropped_frames += due - 1;
+            if (missed) {
+                s_engine.stats.missed_deadlines++;
+            }
+            if (render_us > s_engine.stats.max_render_us) {
+                s_engine.stats.max_render_us = (uint32_t)render_us;
+            }
+            if (jitter_us > s_engine.stats.max_jitter_us) {
+                s_engine.stats.max_jitter_us = (uint32_t)jitter_us;
+            }
+            portEXIT_CRITICAL(&s_engine.lock);
+        }
+        
+        // 每秒更新一次实际帧率、平均渲染耗时和平均抖动
+        int64_t window_us = esp_timer_get_time() - window_start;
+        if (window_us >= 1000000) {
+            portENTER_CRITICAL(&s_engine.lock);
+            s_engine.stats.fps = (uint32_t)(window_frames * 1000000LL / window_us);
+            s_engine.stats.avg_render_us = window_frames ? (uint32_t)(window_render_us / window_frames) : 0;
+            s_engine.stats.avg_jitter_us = window_frames ? (uint32_t)(window_jitter_us / window_frames) : 0;
+            portEXIT_CRITICAL(&s_engine.lock);
+            window_start += window_us;
+            window_frames = 0;
+            window_render_us = 0;
+            window_jitter_us = 0;
+        }
+    }
+    
+    esp_timer_stop(s_engine.timer);
+    esp_timer_delete(s_engine.timer);
+    s_engine.timer = NULL;
+    ws2812b_strip_wait_refresh_done(s_engine.strip, WS2812B_TIMEOUT_MS);
+    s_engine.current = -1;
+    ESP_LOGI(TAG, "渲染任务退出");
+    
+    xTaskNotifyGive(s_engine.stop_waiter);
+    vTaskDelete(NULL);
+}
+
+// 启动效果引擎：创建渲染任务，以fps帧率驱动strip
+// 帧率不能超过灯带整帧线上时间决定的最高帧率，超过时按最高帧率运行；fps为0时直接使用最高帧率
+esp_err_t ws2812b_effect_engine_start(ws2812b_strip_t *strip, uint32_t fps)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "灯带为空");
+    ESP_RETURN_ON_FALSE(!s_engine.running, ESP_ERR_INVALID_STATE, TAG, "效果引擎已在运行");
+    
+    uint32_t max_fps = ws2812b_strip_get_max_fps(strip);
+    if (fps == 0) {
+        fps = max_fps;
+    } else if (fps > max_fps) {
+        ESP_LOGW(TAG, "帧率%lu超过灯带最高帧率%lu（整帧 %lu us），按最高帧率运行", (unsigned long)fps,
+                 (unsigned long)max_fps, (unsigned long)ws2812b_strip_get_frame_time_us(strip));
+        fps = max_fps;
+    }
+    ESP_RETURN_ON_FALSE(fps > 0, ESP_ERR_INVALID_ARG, TAG, "灯带过长，无法达到1 fps");
+    
+    ws2812b_effect_register_builtins();
+    
+    const esp_timer_create_args_t timer_args = {
+        .callback = ws2812b_effect_timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "ws2812b_frame",
+        .skip_unhandled_events = true,
+    };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &s_engine.timer), TAG, "创建帧定时器失败");
+    
+    s_engine.strip = strip;
+    s_engine.fps = fps;
+    s_engine.period_us = 1000000 / fps;
+    memset(&s_engine.stats, 0, sizeof(s_engine.stats));
+    s_engine.stats.target_fps = fps;
+    s_engine.running = true;
+    
+    BaseType_t created = xTaskCreate(ws2812b_effect_task, "ws2812b_effect", WS2812B_TASK_STACK_SIZE,
+                                     NULL, WS2812B_TASK_PRIORITY, &s_engine.task);
+    if (created != pdPASS) {
+        s_engine.running = false;
+        esp_timer_delete(s_engine.timer);
+        s_engine.timer = NULL;
+        ESP_LOGE(TAG, "创建渲染任务失败");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    return ESP_OK;
+}
+
+// 停止效果引擎：等待渲染任务完成当前帧后退出
+esp_err_t ws2812b_effect_engine_stop(void)
+{
+    ESP_RETURN_ON_FALSE(s_engine.running, ESP_ERR_INVALID_STATE, TAG, "效果引擎未运行");
+    
+    s_engine.stop_waiter = xTaskGetCurrentTaskHandle();
+    s_engine.running = false;
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    s_engine.task = NULL;
+    
+    return ESP_OK;
+}
+
+// 切换效果，下一帧生效；name为NULL时停止渲染并熄灭灯带
+esp_err_t ws2812b_effect_select(const char *name)
+{
+    int index = -1;
+    
+    ws2812b_effect_register_builtins();
+    
+    if (name) {
+        index = ws2812b_effect_find(name);
+        ESP_RETURN_ON_FALSE(index >= 0, ESP_ERR_NOT_FOUND, TAG, "未找到效果: %s", name);
+        ESP_LOGI(TAG, "切换效果: %s", name);
+    }
+    
+    s_engine.requested = index;
+    return ESP_OK;
+}
+
+// 设置亮度，由渲染任务在下一帧开始时应用（效果引擎停止时在启动后的第一帧应用）
+esp_err_t ws2812b_effect_set_brightness(uint8_t brightness)
+{
+    atomic_store(&s_engine.requested_brightness, brightness);
+    return ESP_OK;
+}
+
+// 设置调色板效果使用的颜色：写入空闲槽位后发布，渲染任务在下一帧开始时取用，双方都不等待
+// 只允许一个任务调用（如HTTP服务器任务）
+esp_err_t ws2812b_effect_set_palette(const ws2812b_color_t *colors, uint8_t count)
+{
+    ESP_RETURN_ON_FALSE(colors && count > 0 && count <= WS2812B_PALETTE_MAX, ESP_ERR_INVALID_ARG, TAG,
+                        "调色板颜色数无效: %d", count);
+    
+    ws2812b_effect_palette_t *palette = &s_engine.palettes[s_engine.palette_buf.write];
+    memcpy(palette->colors, colors, count * sizeof(ws2812b_color_t));
+    palette->count = count;
+    ws2812b_tribuf_publish(&s_engine.palette_buf);
+    
+    return ESP_OK;
+}
+
+// 获取当前正在运行的效果名称，没有时返回NULL
+const char *ws2812b_effect_get_current(void)
+{
+    int current = s_engine.current;
+    return current >= 0 ? s_engine.effects[current].name : NULL;
+}
+
+// 获取效果引擎统计
+esp_err_t ws2812b_effect_get_stats(ws2812b_effect_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "参数为空");
+    
+    portENTER_CRITICAL(&s_engine.lock);
+    *stats = s_engine.stats;
+    portEXIT_CRITICAL(&s_engine.lock);
+    
+    return ESP_OK;
+}
@@ -0,0 +1,75 @@
+#ifndef WS2812B_EFFECT_H
+#define WS2812B_EFFECT_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "ws2812b_driver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 帧信息：时间均按调度时刻计算，不受任务唤醒抖动影响
+typedef struct {
+    uint32_t index;                     // 帧序号（效果开始后从0计数，丢帧时跳过）
+    int64_t elapsed_us;                 // 本帧的调度时刻距效果开始的时间
+    int64_t deadline_us;                // 本帧必须提交的时刻（esp_timer_get_time()时基），即下一帧的调度时刻
+    uint32_t period_us;                 // 帧周期
+} ws2812b_effect_frame_t;
+
+// 效果渲染函数：按帧的调度时间渲染一帧到灯带后台缓冲区
+// 只根据时间计算画面，丢帧时动画进度不受影响；不需要也不应调用刷新接口
+// 耗时较长的效果可以比较esp_timer_get_time()与deadline_us，来不及时降低本帧的细节
+typedef void (*ws2812b_effect_render_t)(ws2812b_strip_t *strip, const ws2812b_effect_frame_t *frame,
+                                        void *user_ctx);
+
+// 效果描述
+typedef struct {
+    const char *name;                   // 效果名称，用于切换
+    ws2812b_effect_render_t render;     // 每帧渲染函数
+    void *user_ctx;                     // 传给渲染函数的参数
+} ws2812b_effect_t;
+
+// 调色板（WS2812B_EFFECT_PALETTE效果使用）
+typedef struct {
+    ws2812b_color_t colors[WS2812B_PALETTE_MAX];
+    uint8_t count;                      // 有效颜色数，0表示使用默认调色板
+} ws2812b_effect_palette_t;
+
+// 效果引擎统计
+typedef struct {
+    uint32_t frames;                    // 已渲染的帧数
+    uint32_t missed_deadlines;          // 渲染+提交超过截止时刻的帧数
+    uint32_t dropped_frames;            // 上一帧超时导致没有渲染的帧周期数
+    uint32_t target_fps;                // 目标帧率（按灯带最高帧率限制后）
+    uint32_t fps;                       // 最近一个统计周期的实际帧率
+    uint32_t avg_render_us;             // 最近一个统计周期的平均渲染耗时
+    uint32_t max_render_us;             // 启动以来的最大渲染耗时
+    uint32_t avg_jitter_us;             // 最近一个统计周期的平均唤醒抖动（实际开始时刻与调度时刻之差）
+    uint32_t max_jitter_us;             // 启动以来的最大唤醒抖动
+} ws2812b_effect_stats_t;
+
+// 内置效果名称
+#define WS2812B_EFFECT_RAINBOW  "rainbow"   // 彩虹循环
+#define WS2812B_EFFECT_FADE     "fade"      // 红绿蓝依次渐亮渐暗
+#define WS2812B_EFFECT_BLINK    "blink"     // 白色闪烁
+#define WS2812B_EFFECT_BREATH   "breath"    // 三色呼吸灯
+#define WS2812B_EFFECT_PALETTE  "palette"   // 调色板渐变循环
+
+// 效果引擎接口：一个渲染任务以固定帧率驱动一条灯带，fps为0时使用灯带能达到的最高帧率
+esp_err_t ws2812b_effect_register(const ws2812b_effect_t *effect);
+esp_err_t ws2812b_effect_engine_start(ws2812b_strip_t *strip, uint32_t fps);
+esp_err_t ws2812b_effect_engine_stop(void);
+esp_err_t ws2812b_effect_select(const char *name);
+const char *ws2812b_effect_get_current(void);
+
+// 其他任务（如HTTP服务器）修改渲染参数：只写请求，由渲染任务在帧边界应用，不阻塞渲染
+esp_err_t ws2812b_effect_set_brightness(uint8_t brightness);
+esp_err_t ws2812b_effect_set_palette(const ws2812b_color_t *colors, uint8_t count);
+esp_err_t ws2812b_effect_get_stats(ws2812b_effect_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS2812B_EFFECT_H
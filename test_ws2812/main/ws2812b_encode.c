@@ -0,0 +1,165 @@
+#include "ws2812b_backend.h"
+#include <stddef.h>
+#include <string.h>
+
+// ============================================================================
+// WS2812B 线上编码：颜色顺序、芯片时序、SPI位展开和RMT位时序
+// 只用到标准C，不依赖外设驱动，可以在开发机上编译测试（见host/test_waveform.c）
+// ============================================================================
+
+// 各颜色顺序下，线上第n个字节在像素中的偏移
+// 像素按ws2812b_color_t的字段顺序保存（RGB或RGBW），RGBW芯片的白色字节固定在最后发送
+#define WS2812B_W  offsetof(ws2812b_color_t, white)
+WS2812B_ENCODER_DATA const uint8_t ws2812b_order_map[WS2812B_ORDER_MAX][4] = {
+    [WS2812B_ORDER_GRB] = {offsetof(ws2812b_color_t, green), offsetof(ws2812b_color_t, red),   offsetof(ws2812b_color_t, blue),  WS2812B_W},
+    [WS2812B_ORDER_RGB] = {offsetof(ws2812b_color_t, red),   offsetof(ws2812b_color_t, green), offsetof(ws2812b_color_t, blue),  WS2812B_W},
+    [WS2812B_ORDER_BRG] = {offsetof(ws2812b_color_t, blue),  offsetof(ws2812b_color_t, red),   offsetof(ws2812b_color_t, green), WS2812B_W},
+    [WS2812B_ORDER_RBG] = {offsetof(ws2812b_color_t, red),   offsetof(ws2812b_color_t, blue),  offsetof(ws2812b_color_t, green), WS2812B_W},
+    [WS2812B_ORDER_GBR] = {offsetof(ws2812b_color_t, green), offsetof(ws2812b_color_t, blue),  offsetof(ws2812b_color_t, red),   WS2812B_W},
+    [WS2812B_ORDER_BGR] = {offsetof(ws2812b_color_t, blue),  offsetof(ws2812b_color_t, green), offsetof(ws2812b_color_t, red),   WS2812B_W},
+};
+
+// 预定义芯片配置
+const ws2812b_chip_t ws2812b_chip_ws2812b = {
+    .name = "WS2812B",
+    .t0h_ns = WS2812B_T0H_NS,
+    .t0l_ns = WS2812B_T0L_NS,
+    .t1h_ns = WS2812B_T1H_NS,
+    .t1l_ns = WS2812B_T1L_NS,
+    .reset_us = WS2812B_RESET_TIME_US,
+    .bytes_per_pixel = 3,
+    .color_order = WS2812B_COLOR_ORDER,
+};
+
+const ws2812b_chip_t ws2812b_chip_sk6812_rgbw = {
+    .name = "SK6812 RGBW",
+    .t0h_ns = 300,
+    .t0l_ns = 900,
+    .t1h_ns = 600,
+    .t1l_ns = 600,
+    .reset_us = 80,
+    .bytes_per_pixel = 4,
+    .color_order = WS2812B_ORDER_GRB,
+};
+
+const ws2812b_chip_t ws2812b_chip_ws2815 = {
+    .name = "WS2815",
+    .t0h_ns = 300,
+    .t0l_ns = 900,
+    .t1h_ns = 900,
+    .t1l_ns = 300,
+    .reset_us = 280,
+    .bytes_per_pixel = 3,
+    .color_order = WS2812B_ORDER_GRB,
+};
+
+// 字节展开表：像素字节 -> 3个SPI字节，避免逐位处理
+// 每位从高到低展开为3个SPI位（0 -> 0b100，1 -> 0b110），编译期常量表，不需要运行时初始化
+WS2812B_ENCODER_DATA static const uint8_t ws2812b_spi_expand_table[256][WS2812B_SPI_BYTES_PER_BYTE] = {
+    {0x92, 0x49, 0x24}, {0x92, 0x49, 0x26}, {0x92, 0x49, 0x34}, {0x92, 0x49, 0x36},
+    {0x92, 0x49, 0xA4}, {0x92, 0x49, 0xA6}, {0x92, 0x49, 0xB4}, {0x92, 0x49, 0xB6},
+    {0x92, 0x4D, 0x24}, {0x92, 0x4D, 0x26}, {0x92, 0x4D, 0x34}, {0x92, 0x4D, 0x36},
+    {0x92, 0x4D, 0xA4}, {0x92, 0x4D, 0xA6}, {0x92, 0x4D, 0xB4}, {0x92, 0x4D, 0xB6},
+    {0x92, 0x69, 0x24}, {0x92, 0x69, 0x26}, {0x92, 0x69, 0x34}, {0x92, 0x69, 0x36},
+    {0x92, 0x69, 0xA4}, {0x92, 0x69, 0xA6}, {0x92, 0x69, 0xB4}, {0x92, 0x69, 0xB6},
+    {0x92, 0x6D, 0x24}, {0x92, 0x6D, 0x26}, {0x92, 0x6D, 0x34}, {0x92, 0x6D, 0x36},
+    {0x92, 0x6D, 0xA4}, {0x92, 0x6D, 0xA6}, {0x92, 0x6D, 0xB4}, {0x92, 0x6D, 0xB6},
+    {0x93, 0x49, 0x24}, {0x93, 0x49, 0x26}, {0x93, 0x49, 0x34}, {0x93, 0x49, 0x36},
+    {0x93, 0x49, 0xA4}, {0x93, 0x49, 0xA6}, {0x93, 0x49, 0xB4}, {0x93, 0x49, 0xB6},
+    {0x93, 0x4D, 0x24}, {0x93, 0x4D, 0x26}, {0x93, 0x4D, 0x34}, {0x93, 0x4D, 0x36},
+    {0x93, 0x4D, 0xA4}, {0x93, 0x4D, 0xA6}, {0x93, 0x4D, 0xB4}, {0x93, 0x4D, 0xB6},
+    {0x93, 0x69, 0x24}, {0x93, 0x69, 0x26}, {0x93, 0x69, 0x34}, {0x93, 0x69, 0x36},
+    {0x93, 0x69, 0xA4}, {0x93, 0x69, 0xA6}, {0x93, 0x69, 0xB4}, {0x93, 0x69, 0xB6},
+    {0x93, 0x6D, 0x24}, {0x93, 0x6D, 0x26}, {0x93, 0x6D, 0x34}, {0x93, 0x6D, 0x36},
+    {0x93, 0x6D, 0xA4}, {0x93, 0x6D, 0xA6}, {0x93, 0x6D, 0xB4}, {0x93, 0x6D, 0xB6},
+    {0x9A, 0x49, 0x24}, {0x9A, 0x49, 0x26}, {0x9A, 0x49, 0x34}, {0x9A, 0x49, 0x36},
+    {0x9A, 0x49, 0xA4}, {0x9A, 0x49, 0xA6}, {0x9A, 0x49, 0xB4}, {0x9A, 0x49, 0xB6},
+    {0x9A, 0x4D, 0x24}, {0x9A, 0x4D, 0x26}, {0x9A, 0x4D, 0x34}, {0x9A, 0x4D, 0x36},
+    {0x9A, 0x4D, 0xA4}, {0x9A, 0x4D, 0xA6}, {0x9A, 0x4D, 0xB4}, {0x9A, 0x4D, 0xB6},
+    {0x9A, 0x69, 0x24}, {0x9A, 0x69, 0x26}, {0x9A, 0x69, 0x34}, {0x9A, 0x69, 0x36},
+    {0x9A, 0x69, 0xA4}, {0x9A, 0x69, 0xA6}, {0x9A, 0x69, 0xB4}, {0x9A, 0x69, 0xB6},
+    {0x9A, 0x6D, 0x24}, {0x9A, 0x6D, 0x26}, {0x9A, 0x6D, 0x34}, {0x9A, 0x6D, 0x36},
+    {0x9A, 0x6D, 0xA4}, {0x9A, 0x6D, 0xA6}, {0x9A, 0x6D, 0xB4}, {0x9A, 0x6D, 0xB6},
+    {0x9B, 0x49, 0x24}, {0x9B, 0x49, 0x26}, {0x9B, 0x49, 0x34}, {0x9B, 0x49, 0x36},
+    {0x9B, 0x49, 0xA4}, {0x9B, 0x49, 0xA6}, {0x9B, 0x49, 0xB4}, {0x9B, 0x49, 0xB6},
+    {0x9B, 0x4D, 0x24}, {0x9B, 0x4D, 0x26}, {0x9B, 0x4D, 0x34}, {0x9B, 0x4D, 0x36},
+    {0x9B, 0x4D, 0xA4}, {0x9B, 0x4D, 0xA6}, {0x9B, 0x4D, 0xB4}, {0x9B, 0x4D, 0xB6},
+    {0x9B, 0x69, 0x24}, {0x9B, 0x69, 0x26}, {0x9B, 0x69, 0x34}, {0x9B, 0x69, 0x36},
+    {0x9B, 0x69, 0xA4}, {0x9B, 0x69, 0xA6}, {0x9B, 0x69, 0xB4}, {0x9B, 0x69, 0xB6},
+    {0x9B, 0x6D, 0x24}, {0x9B, 0x6D, 0x26}, {0x9B, 0x6D, 0x34}, {0x9B, 0x6D, 0x36},
+    {0x9B, 0x6D, 0xA4}, {0x9B, 0x6D, 0xA6}, {0x9B, 0x6D, 0xB4}, {0x9B, 0x6D, 0xB6},
+    {0xD2, 0x49, 0x24}, {0xD2, 0x49, 0x26}, {0xD2, 0x49, 0x34}, {0xD2, 0x49, 0x36},
+    {0xD2, 0x49, 0xA4}, {0xD2, 0x49, 0xA6}, {0xD2, 0x49, 0xB4}, {0xD2, 0x49, 0xB6},
+    {0xD2, 0x4D, 0x24}, {0xD2, 0x4D, 0x26}, {0xD2, 0x4D, 0x34}, {0xD2, 0x4D, 0x36},
+    {0xD2, 0x4D, 0xA4}, {0xD2, 0x4D, 0xA6}, {0xD2, 0x4D, 0xB4}, {0xD2, 0x4D, 0xB6},
+    {0xD2, 0x69, 0x24}, {0xD2, 0x69, 0x26}, {0xD2, 0x69, 0x34}, {0xD2, 0x69, 0x36},
+    {0xD2, 0x69, 0xA4}, {0xD2, 0x69, 0xA6}, {0xD2, 0x69, 0xB4}, {0xD2, 0x69, 0xB6},
+    {0xD2, 0x6D, 0x24}, {0xD2, 0x6D, 0x26}, {0xD2, 0x6D, 0x34}, {0xD2, 0x6D, 0x36},
+    {0xD2, 0x6D, 0xA4}, {0xD2, 0x6D, 0xA6}, {0xD2, 0x6D, 0xB4}, {0xD2, 0x6D, 0xB6},
+    {0xD3, 0x49, 0x24}, {0xD3, 0x49, 0x26}, {0xD3, 0x49, 0x34}, {0xD3, 0x49, 0x36},
+    {0xD3, 0x49, 0xA4}, {0xD3, 0x49, 0xA6}, {0xD3, 0x49, 0xB4}, {0xD3, 0x49, 0xB6},
+    {0xD3, 0x4D, 0x24}, {0xD3, 0x4D, 0x26}, {0xD3, 0x4D, 0x34}, {0xD3, 0x4D, 0x36},
+    {0xD3, 0x4D, 0xA4}, {0xD3, 0x4D, 0xA6}, {0xD3, 0x4D, 0xB4}, {0xD3, 0x4D, 0xB6},
+    {0xD3, 0x69, 0x24}, {0xD3, 0x69, 0x26}, {0xD3, 0x69, 0x34}, {0xD3, 0x69, 0x36},
+    {0xD3, 0x69, 0xA4}, {0xD3, 0x69, 0xA6}, {0xD3, 0x69, 0xB4}, {0xD3, 0x69, 0xB6},
+    {0xD3, 0x6D, 0x24}, {0xD3, 0x6D, 0x26}, {0xD3, 0x6D, 0x34}, {0xD3, 0x6D, 0x36},
+    {0xD3, 0x6D, 0xA4}, {0xD3, 0x6D, 0xA6}, {0xD3, 0x6D, 0xB4}, {0xD3, 0x6D, 0xB6},
+    {0xDA, 0x49, 0x24}, {0xDA, 0x49, 0x26}, {0xDA, 0x49, 0x34}, {0xDA, 0x49, 0x36},
+    {0xDA, 0x49, 0xA4}, {0xDA, 0x49, 0xA6}, {0xDA, 0x49, 0xB4}, {0xDA, 0x49, 0xB6},
+    {0xDA, 0x4D, 0x24}, {0xDA, 0x4D, 0x26}, {0xDA, 0x4D, 0x34}, {0xDA, 0x4D, 0x36},
+    {0xDA, 0x4D, 0xA4}, {0xDA, 0x4D, 0xA6}, {0xDA, 0x4D, 0xB4}, {0xDA, 0x4D, 0xB6},
+    {0xDA, 0x69, 0x24}, {0xDA, 0x69, 0x26}, {0xDA, 0x69, 0x34}, {0xDA, 0x69, 0x36},
+    {0xDA, 0x69, 0xA4}, {0xDA, 0x69, 0xA6}, {0xDA, 0x69, 0xB4}, {0xDA, 0x69, 0xB6},
+    {0xDA, 0x6D, 0x24}, {0xDA, 0x6D, 0x26}, {0xDA, 0x6D, 0x34}, {0xDA, 0x6D, 0x36},
+    {0xDA, 0x6D, 0xA4}, {0xDA, 0x6D, 0xA6}, {0xDA, 0x6D, 0xB4}, {0xDA, 0x6D, 0xB6},
+    {0xDB, 0x49, 0x24}, {0xDB, 0x49, 0x26}, {0xDB, 0x49, 0x34}, {0xDB, 0x49, 0x36},
+    {0xDB, 0x49, 0xA4}, {0xDB, 0x49, 0xA6}, {0xDB, 0x49, 0xB4}, {0xDB, 0x49, 0xB6},
+    {0xDB, 0x4D, 0x24}, {0xDB, 0x4D, 0x26}, {0xDB, 0x4D, 0x34}, {0xDB, 0x4D, 0x36},
+    {0xDB, 0x4D, 0xA4}, {0xDB, 0x4D, 0xA6}, {0xDB, 0x4D, 0xB4}, {0xDB, 0x4D, 0xB6},
+    {0xDB, 0x69, 0x24}, {0xDB, 0x69, 0x26}, {0xDB, 0x69, 0x34}, {0xDB, 0x69, 0x36},
+    {0xDB, 0x69, 0xA4}, {0xDB, 0x69, 0xA6}, {0xDB, 0x69, 0xB4}, {0xDB, 0x69, 0xB6},
+    {0xDB, 0x6D, 0x24}, {0xDB, 0x6D, 0x26}, {0xDB, 0x6D, 0x34}, {0xDB, 0x6D, 0x36},
+    {0xDB, 0x6D, 0xA4}, {0xDB, 0x6D, 0xA6}, {0xDB, 0x6D, 0xB4}, {0xDB, 0x6D, 0xB6},
+};
+
+// 计算SPI位流字节数
+size_t ws2812b_spi_frame_size(uint16_t led_count, uint8_t bytes_per_pixel)
+{
+    return (size_t)led_count * bytes_per_pixel * WS2812B_SPI_BYTES_PER_BYTE + WS2812B_SPI_RESET_BYTES;
+}
+
+// 将一帧像素按线上顺序、经亮度/伽马查找表后展开为SPI位流，末尾追加复位码
+// lut为NULL时像素已是线上字节（紧凑模式），逐字节直接展开
+void ws2812b_spi_encode_frame(const void *pixels, size_t size, const uint8_t *order, uint8_t bytes_per_pixel,
+                              const uint8_t *lut, uint8_t *out)
+{
+    const uint8_t *pixel = (const uint8_t *)pixels;
+    const uint8_t *end = pixel + size;
+    
+    if (!lut) {
+        for (; pixel < end; pixel++) {
+            memcpy(out, ws2812b_spi_expand_table[*pixel], WS2812B_SPI_BYTES_PER_BYTE);
+            out += WS2812B_SPI_BYTES_PER_BYTE;
+        }
+        memset(out, 0, WS2812B_SPI_RESET_BYTES);
+        return;
+    }
+    
+    for (; pixel < end; pixel += bytes_per_pixel) {
+        for (int channel = 0; channel < bytes_per_pixel; channel++) {
+            memcpy(out, ws2812b_spi_expand_table[lut[pixel[order[channel]]]], WS2812B_SPI_BYTES_PER_BYTE);
+            out += WS2812B_SPI_BYTES_PER_BYTE;
+        }
+    }
+    
+    memset(out, 0, WS2812B_SPI_RESET_BYTES);
+}
+
+// 获取RMT编码器实际使用的位时序（纳秒）：与ws2812b_rmt_bit_symbol()使用同一换算，供波形测试使用
+void ws2812b_rmt_bit_timing(const ws2812b_chip_t *chip, int bit, uint32_t *high_ns, uint32_t *low_ns)
+{
+    uint32_t high = bit ? chip->t1h_ns : chip->t0h_ns;
+    uint32_t low = bit ? chip->t1l_ns : chip->t0l_ns;
+    *high_ns = WS2812B_NS_TO_TICKS(high) * (1000000000 / WS2812B_RMT_RESOLUTION_HZ);
+    *low_ns = WS2812B_NS_TO_TICKS(low) * (1000000000 / WS2812B_RMT_RESOLUTION_HZ);
+}
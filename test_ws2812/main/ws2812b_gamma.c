@@ -0,0 +1,90 @@
+#include "ws2812b_backend.h"
+
+// ============================================================================
+// WS2812B 亮度/伽马查找表
+// LED亮度与PWM占空比近似线性，而人眼感知是非线性的，伽马校正让渐变在低亮度区更均匀
+// ============================================================================
+
+// 伽马校正表（gamma = 2.8），out = round((in / 255)^2.8 * 255)
+const uint8_t ws2812b_gamma_table[256] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      2,   3,   3,   3,   3,   3,   3,   3,   4,   4,   4,   4,   4,   5,   5,   5,
+      5,   6,   6,   6,   6,   7,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,
+     10,  10,  11,  11,  11,  12,  12,  13,  13,  13,  14,  14,  15,  15,  16,  16,
+     17,  17,  18,  18,  19,  19,  20,  20,  21,  21,  22,  22,  23,  24,  24,  25,
+     25,  26,  27,  27,  28,  29,  29,  30,  31,  32,  32,  33,  34,  35,  35,  36,
+     37,  38,  39,  39,  40,  41,  42,  43,  44,  45,  46,  47,  48,  49,  50,  50,
+     51,  52,  54,  55,  56,  57,  58,  59,  60,  61,  62,  63,  64,  66,  67,  68,
+     69,  70,  72,  73,  74,  75,  77,  78,  79,  81,  82,  83,  85,  86,  87,  89,
+     90,  92,  93,  95,  96,  98,  99, 101, 102, 104, 105, 107, 109, 110, 112, 114,
+    115, 117, 119, 120, 122, 124, 126, 127, 129, 131, 133, 135, 137, 138, 140, 142,
+    144, 146, 148, 150, 152, 154, 156, 158, 160, 162, 164, 167, 169, 171, 173, 175,
+    177, 180, 182, 184, 186, 189, 191, 193, 196, 198, 200, 203, 205, 208, 210, 213,
+    215, 218, 220, 223, 225, 228, 231, 233, 236, 239, 241, 244, 247, 249, 252, 255,
+};
+
+// 16位伽马校正表（gamma = 2.8），按输入高8位分段、段内线性插值，满量程为0xFF00
+// 留出低8位的余量，量化误差累加后不会溢出8位输出
+static const uint16_t ws2812b_gamma16_table[257] = {
+        0,     0,     0,     0,     1,     1,     2,     3,     4,     6,     7,    10,
+       12,    16,    19,    23,    28,    33,    39,    45,    52,    59,    68,    77,
+       86,    97,   108,   120,   133,   147,   161,   177,   193,   211,   229,   248,
+      269,   290,   313,   336,   361,   387,   414,   442,   471,   502,   534,   567,
+      601,   637,   674,   713,   753,   794,   836,   880,   926,   973,  1022,  1072,
+     1123,  1177,  1231,  1288,  1346,  1406,  1467,  1530,  1595,  1661,  1730,  1800,
+     1872,  1945,  2021,  2098,  2178,  2259,  2342,  2427,  2514,  2603,  2694,  2787,
+     2882,  2979,  3078,  3180,  3283,  3388,  3496,  3606,  3718,  3832,  3949,  4068,
+     4189,  4312,  4438,  4565,  4696,  4828,  4964,  5101,  5241,  5383,  5528,  5675,
+     5825,  5977,  6132,  6289,  6449,  6612,  6777,  6945,  7115,  7288,  7464,  7643,
+     7824,  8008,  8194,  8384,  8576,  8771,  8969,  9170,  9373,  9580,  9789, 10002,
+    10217, 10435, 10656, 10880, 11108, 11338, 11571, 11807, 12047, 12289, 12535, 12783,
+    13035, 13290, 13549, 13810, 14075, 14343, 14614, 14888, 15166, 15447, 15731, 16019,
+    16310, 16605, 16902, 17204, 17508, 17816, 18128, 18443, 18762, 19084, 19409, 19739,
+    20071, 20408, 20747, 21091, 21438, 21789, 22143, 22502, 22864, 23229, 23598, 23972,
+    24348, 24729, 25114, 25502, 25894, 26290, 26690, 27093, 27501, 27913, 28328, 28748,
+    29171, 29598, 30030, 30465, 30905, 31348, 31796, 32248, 32703, 33163, 33627, 34096,
+    34568, 35044, 35525, 36010, 36499, 36993, 37491, 37993, 38499, 39010, 39525, 40044,
+    40568, 41096, 41628, 42165, 42706, 43252, 43802, 44357, 44916, 45480, 46048, 46621,
+    47198, 47780, 48367, 48958, 49554, 50154, 50759, 51369, 51983, 52602, 53226, 53855,
+    54488, 55126, 55769, 56416, 57069, 57726, 58388, 59055, 59727, 60404, 61086, 61772,
+    62464, 63161, 63862, 64569, 65280,
+};
+
+// 生成亮度/伽马组合查找表：lut[v] = gamma(v) * brightness / 255
+// 仅在亮度或伽马设置变化时调用，编码时每个字节只需一次查表
+void ws2812b_build_lut(uint8_t *lut, uint8_t brightness, bool gamma)
+{
+    for (int value = 0; value < 256; value++) {
+        uint32_t corrected = gamma ? ws2812b_gamma_table[value] : (uint32_t)value;
+        lut[value] = (uint8_t)((corrected * brightness + 127) / 255);
+    }
+}
+
+// 16位帧经伽马/亮度处理后量化为8位，量化误差保留到下一帧（时间抖动）
+// 连续刷新时8位输出的平均值等于16位目标值，低亮度渐变不再有明显台阶
+// scale为亮度系数（brightness * 65536 / 255），每通道只有乘法和移位
+void ws2812b_dither_frame(const ws2812b_color16_t *src, uint8_t *dst, uint8_t *error,
+                          uint16_t led_count, uint32_t scale, bool gamma)
+{
+    const uint16_t *in = (const uint16_t *)src;
+    uint8_t *out = dst;
+    size_t count = (size_t)led_count * 3;
+    
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value = in[i];
+        
+        if (gamma) {
+            const uint16_t *segment = &ws2812b_gamma16_table[value >> 8];
+            value = segment[0] + (((uint32_t)(segment[1] - segment[0]) * (value & 0xFF)) >> 8);
+        } else {
+            value -= value >> 8;    // 0-65535映射到0-0xFF00
+        }
+        
+        value = (value * scale) >> 16;
+        value += error[i];
+        out[i] = (uint8_t)(value >> 8);
+        error[i] = (uint8_t)value;
+    }
+}
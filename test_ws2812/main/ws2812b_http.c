@@ -0,0 +1,473 @@
+#include "ws2812b_http.h"
+#include "ws2812b_effect.h"
+#include "ws2812b_tribuf.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "WS2812B_HTTP";
+
+// 调色板参数最长：每个颜色6位十六进制加URL编码的逗号（%2C）
+#define WS2812B_HTTP_PALETTE_PARAM  (WS2812B_PALETTE_MAX * 9)
+#define WS2812B_HTTP_QUERY_MAX      (WS2812B_HTTP_PALETTE_PARAM + 16)
+
+// 服务器（全局唯一）
+static struct {
+    httpd_handle_t server;
+    ws2812b_strip_t *strip;
+    size_t frame_bytes;                 // 整帧字节数（LED数 × 每像素字节数）
+    uint8_t *frames;                    // 帧三缓冲：3个整帧，HTTP任务写、渲染任务读
+    int64_t publish_time[3];            // 各槽位发布的时刻，用于计算交接延迟
+    ws2812b_tribuf_t frame_buf;
+    bool has_frame;                     // 渲染任务已取到过帧（只在渲染任务中访问）
+    int64_t window_start;               // 统计周期起点
+    uint32_t window_requests;
+    uint64_t window_latency_us;
+    uint64_t window_bytes;
+    uint32_t window_handoffs;
+    uint64_t window_handoff_us;
+    ws2812b_http_stats_t stats;
+    portMUX_TYPE lock;
+} s_http = {
+    .frame_buf = WS2812B_TRIBUF_INIT,
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+// 记录一个请求：处理耗时、上传字节数，每秒更新平均值和吞吐量
+static void ws2812b_http_record(int64_t start, bool ok, size_t upload_bytes)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t elapsed = (uint32_t)(now - start);
+    
+    portENTER_CRITICAL(&s_http.lock);
+    s_http.stats.requests++;
+    if (!ok) {
+        s_http.stats.errors++;
+    }
+    if (elapsed > s_http.stats.max_latency_us) {
+        s_http.stats.max_latency_us = elapsed;
+    }
+    s_http.window_requests++;
+    s_http.window_latency_us += elapsed;
+    s_http.window_bytes += upload_bytes;
+    if (now - s_http.window_start >= 1000000) {
+        s_http.stats.avg_latency_us = (uint32_t)(s_http.window_latency_us / s_http.window_requests);
+        s_http.stats.upload_bytes_per_sec = (uint32_t)(s_http.window_bytes * 1000000 / (now - s_http.window_start));
+        s_http.stats.avg_handoff_us = s_http.window_handoffs ?
+                                      (uint32_t)(s_http.window_handoff_us / s_http.window_handoffs) : 0;
+        s_http.window_start = now;
+        s_http.window_requests = 0;
+        s_http.window_latency_us = 0;
+        s_http.window_bytes = 0;
+        s_http.window_handoffs = 0;
+        s_http.window_handoff_us = 0;
+    }
+    portEXIT_CRITICAL(&s_http.lock);
+}
+
+// 返回错误并记录
+static esp_err_t ws2812b_http_fail(httpd_req_t *req, int64_t start, httpd_err_code_t code, const char *msg)
+{
+    httpd_resp_send_err(req, code, msg);
+    ws2812b_http_record(start, false, 0);
+    return ESP_OK;
+}
+
+// 返回204（无内容）并记录
+static esp_err_t ws2812b_http_done(httpd_req_t *req, int64_t start, size_t upload_bytes)
+{
+    httpd_resp_set_status(req, "204 No Content");
+    httpd_resp_send(req, NULL, 0);
+    ws2812b_http_record(start, true, upload_bytes);
+    return ESP_OK;
+}
+
+// 读取查询参数
+static esp_err_t ws2812b_http_get_param(httpd_req_t *req, const char *key, char *value, size_t size)
+{
+    char query[WS2812B_HTTP_QUERY_MAX];
+    
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return httpd_query_key_value(query, key, value, size);
+}
+
+// ============================================================================
+// 帧效果：显示最近一次上传的整帧
+// ============================================================================
+
+// 在渲染任务中运行：有新帧时换到最新槽位并写入灯带，没有新帧时灯带保持不变（刷新会被跳过）
+static void ws2812b_http_render(ws2812b_strip_t *strip, const ws2812b_effect_frame_t *frame, void *user_ctx)
+{
+    bool fresh = ws2812b_tribuf_acquire(&s_http.frame_buf);
+    
+    if (fresh) {
+        uint32_t handoff = (uint32_t)(esp_timer_get_time() - s_http.publish_time[s_http.frame_buf.read]);
+        s_http.has_frame = true;
+        portENTER_CRITICAL(&s_http.lock);
+        s_http.window_handoffs++;
+        s_http.window_handoff_us += handoff;
+        if (handoff > s_http.stats.max_handoff_us) {
+            s_http.stats.max_handoff_us = handoff;
+        }
+        portEXIT_CRITICAL(&s_http.lock);
+    }
+    
+    // 刚切换到本效果时重新写入，其他效果可能改写过灯带
+    if (s_http.has_frame && (fresh || frame->index == 0)) {
+        ws2812b_strip_write_channels(strip, 0, s_http.frames + s_http.frame_buf.read * s_http.frame_bytes,
+                                     ws2812b_strip_get_led_count(strip));
+    }
+}
+
+// ============================================================================
+// 请求处理
+// ============================================================================
+
+// GET /api/status
+static esp_err_t ws2812b_http_status_handler(httpd_req_t *req)
+{
+    int64_t start = esp_timer_get_time();
+    ws2812b_effect_stats_t effect_stats = {0};
+    char json[256];
+    
+    ws2812b_effect_get_stats(&effect_stats);
+    const char *effect = ws2812b_effect_get_current();
+    snprintf(json, sizeof(json),
+             "{\"effect\":\"%s\",\"brightness\":%u,\"leds\":%u,\"bytes_per_pixel\":%u,"
+             "\"fps\":%lu,\"target_fps\":%lu,\"frame_bytes\":%u}",
+             effect ? effect : "off", ws2812b_strip_get_brightness(s_http.strip),
+             ws2812b_strip_get_led_count(s_http.strip), ws2812b_strip_get_bytes_per_pixel(s_http.strip),
+             (unsigned long)effect_stats.fps, (unsigned long)effect_stats.target_fps,
+             (unsigned)s_http.frame_bytes);
+    
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, json);
+    ws2812b_http_record(start, true, 0);
+    return ESP_OK;
+}
+
+// GET /api/stats
+static esp_err_t ws2812b_http_stats_handler(httpd_req_t *req)
+{
+    int64_t start = esp_timer_get_time();
+    ws2812b_http_stats_t stats;
+    char json[320];
+    
+    ws2812b_http_get_stats(&stats);
+    snprintf(json, sizeof(json),
+             "{\"requests\":%lu,\"errors\":%lu,\"avg_latency_us\":%lu,\"max_latency_us\":%lu,"
+             "\"frames\":%lu,\"frames_overwritten\":%lu,\"upload_bytes_per_sec\":%lu,"
+             "\"avg_handoff_us\":%lu,\"max_handoff_us\":%lu}",
+             (unsigned long)stats.requests, (unsigned long)stats.errors, (unsigned long)stats.avg_latency_us,
+             (unsigned long)stats.max_latency_us, (unsigned long)stats.frames,
+             (unsigned long)stats.frames_overwritten, (unsigned long)stats.upload_bytes_per_sec,
+             (unsigned long)stats.avg_handoff_us, (unsigned long)stats.max_handoff_us);
+    
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, json);
+    ws2812b_http_record(start, true, 0);
+    return ESP_OK;
+}
+
+// POST /api/effect?name=xxx
+static esp_err_t ws2812b_http_effect_handler(httpd_req_t *req)
+{
+    int64_t start = esp_timer_get_time();
+    char name[32];
+    
+    if (ws2812b_http_get_param(req, "name", name, sizeof(name)) != ESP_OK) {
+        return ws2812b_http_fail(req, start, HTTPD_400_BAD_REQUEST, "缺少参数name");
+    }
+    if (ws2812b_effect_select(strcmp(name, "off") == 0 ? NULL : name) != ESP_OK) {
+        return ws2812b_http_fail(req, start, HTTPD_404_NOT_FOUND, "未找到效果");
+    }
+    return ws2812b_http_done(req, start, 0);
+}
+
+// POST /api/brightness?value=0-255
+static esp_err_t ws2812b_http_brightness_handler(httpd_req_t *req)
+{
+    int64_t start = esp_timer_get_time();
+    char value[8];
+    char *end;
+    
+    if (ws2812b_http_get_param(req, "value", value, sizeof(value)) != ESP_OK) {
+        return ws2812b_http_fail(req, start, HTTPD_400_BAD_REQUEST, "缺少参数value");
+    }
+    long brightness = strtol(value, &end, 10);
+    if (end == value || *end != '\0' || brightness < 0 || brightness > 255) {
+        return ws2812b_http_fail(req, start, HTTPD_400_BAD_REQUEST, "亮度应为0-255");
+    }
+    ws2812b_effect_set_brightness((uint8_t)brightness);
+    return ws2812b_http_done(req, start, 0);
+}
+
+// POST /api/palette?colors=RRGGBB,RRGGBB,...
+static esp_err_t ws2812b_http_palette_handler(httpd_req_t *req)
+{
+    int64_t start = esp_timer_get_time();
+    char value[WS2812B_HTTP_PALETTE_PARAM];
+    ws2812b_color_t colors[WS2812B_PALETTE_MAX];
+    uint8_t count = 0;
+    
+    if (ws2812b_http_get_param(req, "colors", value, sizeof(value)) != ESP_OK) {
+        return ws2812b_http_fail(req, start, HTTPD_400_BAD_REQUEST, "缺少参数colors");
+    }
+    
+    // %2C是URL编码后的逗号，两种写法都接受
+    for (char *p = value; *p;) {
+        char *end;
+        unsigned long rgb = strtoul(p, &end, 16);
+        if (end - p != 6 || count >= WS2812B_PALETTE_MAX) {
+            return ws2812b_http_fail(req, start, HTTPD_400_BAD_REQUEST, "颜色格式应为RRGGBB，以逗号分隔");
+        }
+        colors[count++] = (ws2812b_color_t){(rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF, 0};
+        if (*end == ',') {
+            end++;
+        } else if (strncmp(end, "%2C", 3) == 0 || strncmp(end, "%2c", 3) == 0) {
+            end += 3;
+        }
+        p = end;
+    }
+    if (count == 0) {
+        return ws2812b_http_fail(req, start, HTTPD_400_BAD_REQUEST, "调色板为空");
+    }
+    
+    ws2812b_effect_set_palette(colors, count);
+    return ws2812b_http_done(req, start, 0);
+}
+
+// POST /api/frame：请求体直接接收到三缓冲的写入槽位，收完后发布，渲染任务下一帧取用
+static esp_err_t ws2812b_http_frame_handler(httpd_req_t *req)
+{
+    int64_t start = esp_timer_get_time();
+    
+    if (req->content_len != s_http.frame_bytes) {
+        return ws2812b_http_fail(req, start, HTTPD_400_BAD_REQUEST, "请求体大小应为LED数×每像素字节数");
+    }
+    
+    uint8_t *slot = s_http.frames + s_http.frame_buf.write * s_http.frame_bytes;
+    size_t received = 0;
+    while (received < s_http.frame_bytes) {
+        int ret = httpd_req_recv(req, (char *)slot + received, s_http.frame_bytes - received);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;
+        }
+        if (ret <= 0) {
+            // 连接已断开，不发送响应；槽位没有发布，下次上传直接覆盖
+            ws2812b_http_record(start, false, received);
+            return ESP_FAIL;
+        }
+        received += ret;
+    }
+    
+    s_http.publish_time[s_http.frame_buf.write] = esp_timer_get_time();
+    bool overwritten = ws2812b_tribuf_publish(&s_http.frame_buf);
+    portENTER_CRITICAL(&s_http.lock);
+    s_http.stats.frames++;
+    if (overwritten) {
+        s_http.stats.frames_overwritten++;
+    }
+    portEXIT_CRITICAL(&s_http.lock);
+    
+    const char *current = ws2812b_effect_get_current();
+    if (!current || strcmp(current, WS2812B_EFFECT_HTTP_FRAME) != 0) {
+        ws2812b_effect_select(WS2812B_EFFECT_HTTP_FRAME);
+    }
+    return ws2812b_http_done(req, start, received);
+}
+
+static const httpd_uri_t ws2812b_http_uris[] = {
+    {.uri = "/api/status",     .method = HTTP_GET,  .handler = ws2812b_http_status_handler},
+    {.uri = "/api/stats",      .method = HTTP_GET,  .handler = ws2812b_http_stats_handler},
+    {.uri = "/api/effect",     .method = HTTP_POST, .handler = ws2812b_http_effect_handler},
+    {.uri = "/api/brightness", .method = HTTP_POST, .handler = ws2812b_http_brightness_handler},
+    {.uri = "/api/palette",    .method = HTTP_POST, .handler = ws2812b_http_palette_handler},
+    {.uri = "/api/frame",      .method = HTTP_POST, .handler = ws2812b_http_frame_handler},
+};
+
+// ============================================================================
+// 服务器
+// ============================================================================
+
+// 启动HTTP服务器，注册帧效果
+// 帧缓冲区在第一次启动时分配，停止后保留（帧效果可能仍在使用）
+esp_err_t ws2812b_http_start(const ws2812b_http_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(config && config->strip, ESP_ERR_INVALID_ARG, TAG, "参数为空");
+    ESP_RETURN_ON_FALSE(!s_http.server, ESP_ERR_INVALID_STATE, TAG, "服务器已在运行");
+    
+    size_t frame_bytes = (size_t)ws2812b_strip_get_led_count(config->strip) *
+                         ws2812b_strip_get_bytes_per_pixel(config->strip);
+    if (!s_http.frames) {
+        s_http.frames = calloc(3, frame_bytes);
+        ESP_RETURN_ON_FALSE(s_http.frames, ESP_ERR_NO_MEM, TAG, "分配帧缓冲区失败");
+        s_http.strip = config->strip;
+        s_http.frame_bytes = frame_bytes;
+        
+        ws2812b_effect_t effect = {
+            .name = WS2812B_EFFECT_HTTP_FRAME,
+            .render = ws2812b_http_render,
+        };
+        esp_err_t ret = ws2812b_effect_register(&effect);
+        if (ret != ESP_OK) {
+            // 释放缓冲区，下次启动时重新注册
+            ESP_LOGE(TAG, "注册帧效果失败: %s", esp_err_to_name(ret));
+            free(s_http.frames);
+            s_http.frames = NULL;
+            s_http.strip = NULL;
+            s_http.frame_bytes = 0;
+            return ret;
+        }
+    }
+    ESP_RETURN_ON_FALSE(config->strip == s_http.strip, ESP_ERR_INVALID_ARG, TAG, "不能更换灯带");
+    
+    httpd_config_t httpd_config = HTTPD_DEFAULT_CONFIG();
+    httpd_config.server_port = config->port ? config->port : WS2812B_HTTP_PORT;
+    httpd_config.stack_size = WS2812B_HTTP_TASK_STACK_SIZE;
+    httpd_config.max_uri_handlers = sizeof(ws2812b_http_uris) / sizeof(ws2812b_http_uris[0]);
+    httpd_config.lru_purge_enable = true;
+    
+    s_http.window_start = esp_timer_get_time();
+    ESP_RETURN_ON_ERROR(httpd_start(&s_http.server, &httpd_config), TAG, "启动HTTP服务器失败");
+    for (size_t i = 0; i < sizeof(ws2812b_http_uris) / sizeof(ws2812b_http_uris[0]); i++) {
+        httpd_register_uri_handler(s_http.server, &ws2812b_http_uris[i]);
+    }
+    
+    ESP_LOGI(TAG, "HTTP服务器启动，端口%d，整帧%u字节", httpd_config.server_port, (unsigned)frame_bytes);
+    return ESP_OK;
+}
+
+// 停止HTTP服务器
+esp_err_t ws2812b_http_stop(void)
+{
+    ESP_RETURN_ON_FALSE(s_http.server, ESP_ERR_INVALID_STATE, TAG, "服务器未运行");
+    
+    esp_err_t ret = httpd_stop(s_http.server);
+    s_http.server = NULL;
+    return ret;
+}
+
+// 获取接口统计
+esp_err_t ws2812b_http_get_stats(ws2812b_http_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "参数为空");
+    
+    portENTER_CRITICAL(&s_http.lock);
+    *stats = s_http.stats;
+    portEXIT_CRITICAL(&s_http.lock);
+    
+    return ESP_OK;
+}
+
+// ============================================================================
+// 测试函数
+// ============================================================================
+
+// 交接测试的共享状态
+static struct {
+    ws2812b_tribuf_t buf;
+    uint8_t *frames;
+    size_t frame_bytes;
+    uint32_t count;                     // 要发布的帧数
+    uint32_t overwritten;
+    TaskHandle_t waiter;
+    volatile bool done;
+} s_handoff_test;
+
+// 生产者：每帧前4字节写帧号，其余字节都填帧号的低8位，写完即发布
+static void ws2812b_http_test_producer(void *arg)
+{
+    for (uint32_t n = 1; n <= s_handoff_test.count; n++) {
+        uint8_t *slot = s_handoff_test.frames + s_handoff_test.buf.write * s_handoff_test.frame_bytes;
+        memcpy(slot, &n, sizeof(n));
+        memset(slot + sizeof(n), (uint8_t)n, s_handoff_test.frame_bytes - sizeof(n));
+        if (ws2812b_tribuf_publish(&s_handoff_test.buf)) {
+            s_handoff_test.overwritten++;
+        }
+        taskYIELD();
+    }
+    s_handoff_test.done = true;
+    xTaskNotifyGive(s_handoff_test.waiter);
+    vTaskDelete(NULL);
+}
+
+// 三缓冲交接自检：生产者与调用者同优先级并发运行，调用者每个节拍取一次最新帧
+bool ws2812b_http_test_handoff(ws2812b_strip_t *strip, uint32_t frames)
+{
+    bool passed = true;
+    uint32_t last = 0;
+    uint32_t acquired = 0;
+    
+    size_t frame_bytes = (size_t)ws2812b_strip_get_led_count(strip) * ws2812b_strip_get_bytes_per_pixel(strip);
+    if (frame_bytes < sizeof(uint32_t) + 1 || frames == 0) {
+        return false;
+    }
+    
+    ws2812b_tribuf_init(&s_handoff_test.buf);
+    s_handoff_test.frames = calloc(3, frame_bytes);
+    if (!s_handoff_test.frames) {
+        return false;
+    }
+    s_handoff_test.frame_bytes = frame_bytes;
+    s_handoff_test.count = frames;
+    s_handoff_test.overwritten = 0;
+    s_handoff_test.waiter = xTaskGetCurrentTaskHandle();
+    s_handoff_test.done = false;
+    
+    int64_t start = esp_timer_get_time();
+    if (xTaskCreate(ws2812b_http_test_producer, "http_test", 2048, NULL, uxTaskPriorityGet(NULL), NULL) != pdPASS) {
+        free(s_handoff_test.frames);
+        return false;
+    }
+    
+    // 生产者结束后再取一次，最后一帧一定能取到
+    bool finished = false;
+    while (!finished) {
+        finished = s_handoff_test.done;
+        if (!ws2812b_tribuf_acquire(&s_handoff_test.buf)) {
+            vTaskDelay(1);
+            continue;
+        }
+        
+        const uint8_t *slot = s_handoff_test.frames + s_handoff_test.buf.read * frame_bytes;
+        uint32_t n;
+        memcpy(&n, slot, sizeof(n));
+        for (size_t i = sizeof(n); i < frame_bytes; i++) {
+            if (slot[i] != (uint8_t)n) {
+                ESP_LOGE(TAG, "帧%lu被撕裂（第%u字节）", (unsigned long)n, (unsigned)i);
+                passed = false;
+                break;
+            }
+        }
+        if (n <= last) {
+            ESP_LOGE(TAG, "帧号倒退: %lu -> %lu", (unsigned long)last, (unsigned long)n);
+            passed = false;
+        }
+        last = n;
+        acquired++;
+        vTaskDelay(1);
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int64_t elapsed_us = esp_timer_get_time() - start;
+    free(s_handoff_test.frames);
+    
+    ESP_LOGI(TAG, "发布 %lu 帧（每帧%u字节），取用 %lu 帧，覆盖 %lu 帧，耗时 %lld us",
+             (unsigned long)frames, (unsigned)frame_bytes, (unsigned long)acquired,
+             (unsigned long)s_handoff_test.overwritten, (long long)elapsed_us);
+    if (last != frames || acquired + s_handoff_test.overwritten != frames) {
+        ESP_LOGE(TAG, "帧数不符：最后取到%lu", (unsigned long)last);
+        passed = false;
+    }
+    
+    ESP_LOGI(TAG, "三缓冲交接自检%s", passed ? "通过" : "失败");
+    return passed;
+}
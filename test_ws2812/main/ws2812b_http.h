@@ -0,0 +1,57 @@
+#ifndef WS2812B_HTTP_H
+#define WS2812B_HTTP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "ws2812b_driver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// HTTP控制接口（esp_http_server）：
+//   GET  /api/status                          当前效果、亮度、帧率等（JSON）
+//   GET  /api/stats                           HTTP接口统计（JSON）
+//   POST /api/effect?name=rainbow             切换效果，name=off熄灭
+//   POST /api/brightness?value=128            设置亮度（0-255）
+//   POST /api/palette?colors=FF0000,00FF00    设置调色板效果的颜色（RRGGBB，最多WS2812B_PALETTE_MAX个）
+//   POST /api/frame                           请求体为整帧二进制像素，每LED按R、G、B（RGBW灯带再加W）排列
+// 所有修改都只写请求，由效果引擎的渲染任务在帧边界取用，HTTP处理不会阻塞渲染
+
+// 上传的帧通过该效果显示（上传时自动切换）
+#define WS2812B_EFFECT_HTTP_FRAME   "frame"
+
+// 服务器配置
+typedef struct {
+    ws2812b_strip_t *strip;             // 效果引擎驱动的灯带，决定整帧大小
+    uint16_t port;                      // 端口，0为WS2812B_HTTP_PORT
+} ws2812b_http_config_t;
+
+// 接口统计
+typedef struct {
+    uint32_t requests;                  // 已处理的请求
+    uint32_t errors;                    // 返回错误的请求
+    uint32_t avg_latency_us;            // 最近一个统计周期请求的平均处理耗时（从处理函数开始到响应发出）
+    uint32_t max_latency_us;            // 请求最大处理耗时
+    uint32_t frames;                    // 已上传的帧
+    uint32_t frames_overwritten;        // 渲染任务取用前就被下一帧覆盖的帧
+    uint32_t upload_bytes_per_sec;      // 最近一个统计周期的帧上传吞吐量
+    uint32_t avg_handoff_us;            // 最近一个统计周期帧从上传完成到被渲染任务取用的平均延迟
+    uint32_t max_handoff_us;            // 最大交接延迟
+} ws2812b_http_stats_t;
+
+// 服务器接口（全局唯一）：通常在获取IP后启动
+esp_err_t ws2812b_http_start(const ws2812b_http_config_t *config);
+esp_err_t ws2812b_http_stop(void);
+esp_err_t ws2812b_http_get_stats(ws2812b_http_stats_t *stats);
+
+// 测试函数：一个任务以最快速度发布整帧，调用者同时取用，检查取到的帧没有被撕裂、帧号只增不减
+// 不经过网络和效果引擎，服务器运行时不能调用
+bool ws2812b_http_test_handoff(ws2812b_strip_t *strip, uint32_t frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS2812B_HTTP_H
@@ -0,0 +1,343 @@
+#include "ws2812b_backend.h"
+#include "driver/rmt_tx.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "soc/soc_caps.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "WS2812B_RMT";
+
+// RMT后端
+typedef struct {
+    ws2812b_backend_t base;
+    rmt_channel_handle_t tx_chan;           // RMT发送通道
+    rmt_encoder_handle_t encoder;           // 常驻编码器，避免每帧创建/删除
+    ws2812b_backend_done_cb_t on_done;      // 发送完成通知
+    void *user_ctx;
+} ws2812b_rmt_backend_t;
+
+// 芯片时序（纳秒）换算为RMT位符号，如WS2812B 0码 350ns/800ns @10MHz ≈ 4/8个节拍
+static rmt_symbol_word_t ws2812b_rmt_bit_symbol(uint32_t high_ns, uint32_t low_ns)
+{
+    return (rmt_symbol_word_t){
+        .level0 = 1,
+        .duration0 = WS2812B_NS_TO_TICKS(high_ns),
+        .level1 = 0,
+        .duration1 = WS2812B_NS_TO_TICKS(low_ns),
+    };
+}
+
+// 编码器状态
+typedef enum {
+    WS2812B_ENC_STATE_PIXELS = 0,   // 发送像素数据
+    WS2812B_ENC_STATE_RESET,        // 发送复位码
+} ws2812b_encoder_state_t;
+
+// WS2812B复合编码器：字节编码器负责像素数据，拷贝编码器负责复位码
+typedef struct {
+    rmt_encoder_t base;
+    rmt_encoder_t *bytes_encoder;
+    rmt_encoder_t *copy_encoder;
+    ws2812b_encoder_state_t state;
+    size_t pixel_offset;            // 当前像素在缓冲区中的字节偏移
+    uint8_t channel;                // 当前像素内的线上字节序号（0到每像素字节数-1）
+    const uint8_t *order;           // 线上字节顺序映射
+    const uint8_t *lut;             // 本帧使用的亮度/伽马查找表，NULL表示紧凑模式直接发送
+    uint8_t out_byte;               // 当前字节查表后的值，交给字节编码器
+    rmt_symbol_word_t reset_code;   // 复位码：低电平保持芯片复位时间，拆成两段各占一半
+    int64_t last_call_us;           // 本帧上一次被调用的时间，0表示新的一帧
+    uint32_t refill_budget_us;      // RMT内存全部发完所需时间，两次补充间隔超过它即发生欠载
+    volatile uint32_t late_refills; // 补充数据过晚（欠载）的次数
+} ws2812b_encoder_t;
+
+// 编码函数：按线上顺序逐字节取像素数据，不需要额外的重排缓冲区
+// bytes_per_pixel为编译期常量，由下面按像素格式特化的入口函数内联展开
+FORCE_INLINE_ATTR size_t ws2812b_encode_pixels(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
+                                               const void *primary_data, size_t data_size,
+                                               rmt_encode_state_t *ret_state, const uint8_t bytes_per_pixel)
+{
+    ws2812b_encoder_t *led_encoder = __containerof(encoder, ws2812b_encoder_t, base);
+    rmt_encoder_handle_t bytes_encoder = led_encoder->bytes_encoder;
+    rmt_encoder_handle_t copy_encoder = led_encoder->copy_encoder;
+    const uint8_t *pixels = (const uint8_t *)primary_data;
+    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    size_t encoded_symbols = 0;
+    
+#if WS2812B_STREAM_UNDERRUN_CHECK
+    // 欠载检测：同一帧内两次补充的间隔超过整个RMT内存的发送时间，说明硬件已经读空
+    int64_t now = esp_timer_get_time();
+    if (led_encoder->last_call_us && now - led_encoder->last_call_us > led_encoder->refill_budget_us) {
+        led_encoder->late_refills++;
+    }
+    led_encoder->last_call_us = now;
+#endif
+    
+    switch (led_encoder->state) {
+    case WS2812B_ENC_STATE_PIXELS:
+        if (!led_encoder->lut && led_encoder->pixel_offset < data_size) {
+            // 紧凑模式：缓冲区已是线上字节，整帧交给字节编码器，内存满后由其记录进度
+            encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, pixels, data_size, &session_state);
+            if (session_state & RMT_ENCODING_COMPLETE) {
+                led_encoder->pixel_offset = data_size;
+            }
+            if (session_state & RMT_ENCODING_MEM_FULL) {
+                state |= RMT_ENCODING_MEM_FULL;
+                goto out;
+            }
+        }
+        while (led_encoder->pixel_offset < data_size) {
+            // 发送期间像素与查找表不变，内存满后重入时重新查表得到同一个值
+            uint8_t value = pixels[led_encoder->pixel_offset + led_encoder->order[led_encoder->channel]];
+            led_encoder->out_byte = led_encoder->lut[value];
+            encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, &led_encoder->out_byte, 1,
+                                                     &session_state);
+            if (session_state & RMT_ENCODING_COMPLETE) {
+                if (++led_encoder->channel == bytes_per_pixel) {
+                    led_encoder->channel = 0;
+                    led_encoder->pixel_offset += bytes_per_pixel;
+                }
+            }
+            if (session_state & RMT_ENCODING_MEM_FULL) {
+                // RMT内存已满，下次从当前字节继续
+                state |= RMT_ENCODING_MEM_FULL;
+                goto out;
+            }
+        }
+        led_encoder->state = WS2812B_ENC_STATE_RESET;
+        // fall-through
+    case WS2812B_ENC_STATE_RESET:
+        encoded_symbols += copy_encoder->encode(copy_encoder, channel, &led_encoder->reset_code,
+                                                sizeof(led_encoder->reset_code), &session_state);
+        if (session_state & RMT_ENCODING_COMPLETE) {
+            led_encoder->state = WS2812B_ENC_STATE_PIXELS;
+            led_encoder->pixel_offset = 0;
+            led_encoder->channel = 0;
+            led_encoder->last_call_us = 0;
+            state |= RMT_ENCODING_COMPLETE;
+        }
+        if (session_state & RMT_ENCODING_MEM_FULL) {
+            state |= RMT_ENCODING_MEM_FULL;
+            goto out;
+        }
+    }
+out:
+    *ret_state = state;
+    return encoded_symbols;
+}
+
+// RGB芯片（3字节/像素）编码入口
+static size_t WS2812B_ENCODER_ATTR ws2812b_encode_rgb(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
+                                                      const void *primary_data, size_t data_size,
+                                                      rmt_encode_state_t *ret_state)
+{
+    return ws2812b_encode_pixels(encoder, channel, primary_data, data_size, ret_state, 3);
+}
+
+// RGBW芯片（4字节/像素）编码入口
+static size_t WS2812B_ENCODER_ATTR ws2812b_encode_rgbw(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
+                                                       const void *primary_data, size_t data_size,
+                                                       rmt_encode_state_t *ret_state)
+{
+    return ws2812b_encode_pixels(encoder, channel, primary_data, data_size, ret_state, 4);
+}
+
+// 删除编码器
+static esp_err_t ws2812b_del_encoder(rmt_encoder_t *encoder)
+{
+    ws2812b_encoder_t *led_encoder = __containerof(encoder, ws2812b_encoder_t, base);
+    rmt_del_encoder(led_encoder->bytes_encoder);
+    rmt_del_encoder(led_encoder->copy_encoder);
+    free(led_encoder);
+    return ESP_OK;
+}
+
+// 复位编码器
+static esp_err_t WS2812B_ENCODER_ATTR ws2812b_reset_encoder(rmt_encoder_t *encoder)
+{
+    ws2812b_encoder_t *led_encoder = __containerof(encoder, ws2812b_encoder_t, base);
+    rmt_encoder_reset(led_encoder->bytes_encoder);
+    rmt_encoder_reset(led_encoder->copy_encoder);
+    led_encoder->state = WS2812B_ENC_STATE_PIXELS;
+    led_encoder->pixel_offset = 0;
+    led_encoder->channel = 0;
+    led_encoder->last_call_us = 0;
+    return ESP_OK;
+}
+
+// 创建编码器：按芯片选择特化的编码函数，时序换算为RMT符号
+static esp_err_t ws2812b_rmt_new_encoder(const ws2812b_chip_t *chip, ws2812b_color_order_t order,
+                                         size_t mem_block_symbols, rmt_encoder_handle_t *ret_encoder)
+{
+    esp_err_t ret = ESP_OK;
+    ws2812b_encoder_t *led_encoder = NULL;
+    
+    led_encoder = calloc(1, sizeof(ws2812b_encoder_t));
+    ESP_RETURN_ON_FALSE(led_encoder, ESP_ERR_NO_MEM, TAG, "分配编码器内存失败");
+    
+    led_encoder->base.encode = chip->bytes_per_pixel == 4 ? ws2812b_encode_rgbw : ws2812b_encode_rgb;
+    led_encoder->base.del = ws2812b_del_encoder;
+    led_encoder->base.reset = ws2812b_reset_encoder;
+    led_encoder->order = ws2812b_order_map[order];
+    led_encoder->refill_budget_us = mem_block_symbols * (chip->t0h_ns + chip->t0l_ns) / 1000;
+    led_encoder->reset_code = (rmt_symbol_word_t){
+        .level0 = 0,
+        .duration0 = WS2812B_US_TO_TICKS(chip->reset_us) / 2,
+        .level1 = 0,
+        .duration1 = WS2812B_US_TO_TICKS(chip->reset_us) / 2,
+    };
+    
+    // 创建字节编码器
+    rmt_bytes_encoder_config_t bytes_encoder_config = {
+        .bit0 = ws2812b_rmt_bit_symbol(chip->t0h_ns, chip->t0l_ns),
+        .bit1 = ws2812b_rmt_bit_symbol(chip->t1h_ns, chip->t1l_ns),
+        .flags.msb_first = 1,
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_bytes_encoder(&bytes_encoder_config, &led_encoder->bytes_encoder),
+                      err, TAG, "创建字节编码器失败");
+    
+    // 创建拷贝编码器（用于复位码）
+    rmt_copy_encoder_config_t copy_encoder_config = {};
+    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &led_encoder->copy_encoder),
+                      err, TAG, "创建拷贝编码器失败");
+    
+    *ret_encoder = &led_encoder->base;
+    return ESP_OK;
+    
+err:
+    if (led_encoder->bytes_encoder) {
+        rmt_del_encoder(led_encoder->bytes_encoder);
+    }
+    free(led_encoder);
+    return ret;
+}
+
+// RMT发送完成回调（中断上下文）
+static bool IRAM_ATTR ws2812b_rmt_tx_done_isr(rmt_channel_handle_t channel,
+                                              const rmt_tx_done_event_data_t *edata,
+                                              void *user_ctx)
+{
+    ws2812b_rmt_backend_t *rmt_backend = (ws2812b_rmt_backend_t *)user_ctx;
+    return rmt_backend->on_done(rmt_backend->user_ctx);
+}
+
+// 发送一帧
+static esp_err_t ws2812b_rmt_transmit(ws2812b_backend_t *backend, const void *pixels, size_t size,
+                                      const uint8_t *lut, bool nonblocking)
+{
+    ws2812b_rmt_backend_t *rmt_backend = __containerof(backend, ws2812b_rmt_backend_t, base);
+    ws2812b_encoder_t *led_encoder = __containerof(rmt_backend->encoder, ws2812b_encoder_t, base);
+    
+    // 驱动提交前先等待上一帧完成（队列深度为1），同一时刻只有一帧在发送，直接把查找表交给编码器
+    led_encoder->lut = lut;
+    
+    rmt_transmit_config_t tx_config = {
+        .loop_count = 0,
+        .flags.queue_nonblocking = nonblocking,
+    };
+    
+    return rmt_transmit(rmt_backend->tx_chan, rmt_backend->encoder, pixels, size, &tx_config);
+}
+
+// 等待发送完成（复位码已包含在编码中，完成即已锁存）
+static esp_err_t ws2812b_rmt_wait_done(ws2812b_backend_t *backend, int timeout_ms)
+{
+    ws2812b_rmt_backend_t *rmt_backend = __containerof(backend, ws2812b_rmt_backend_t, base);
+    return rmt_tx_wait_all_done(rmt_backend->tx_chan, timeout_ms);
+}
+
+// 获取欠载次数
+static uint32_t ws2812b_rmt_get_underruns(ws2812b_backend_t *backend)
+{
+    ws2812b_rmt_backend_t *rmt_backend = __containerof(backend, ws2812b_rmt_backend_t, base);
+    ws2812b_encoder_t *led_encoder = __containerof(rmt_backend->encoder, ws2812b_encoder_t, base);
+    return led_encoder->late_refills;
+}
+
+// 删除后端
+static esp_err_t ws2812b_rmt_del(ws2812b_backend_t *backend)
+{
+    ws2812b_rmt_backend_t *rmt_backend = __containerof(backend, ws2812b_rmt_backend_t, base);
+    
+    // 等待正在发送的帧完成，避免删除通道时缓冲区仍被读取
+    rmt_tx_wait_all_done(rmt_backend->tx_chan, WS2812B_TIMEOUT_MS);
+    rmt_disable(rmt_backend->tx_chan);
+    rmt_del_channel(rmt_backend->tx_chan);
+    rmt_del_encoder(rmt_backend->encoder);
+    free(rmt_backend);
+    
+    return ESP_OK;
+}
+
+// 创建RMT后端
+esp_err_t ws2812b_new_rmt_backend(const ws2812b_backend_config_t *config, ws2812b_backend_t **ret_backend)
+{
+    esp_err_t ret = ESP_OK;
+    
+    ESP_RETURN_ON_FALSE(config && ret_backend && config->on_done, ESP_ERR_INVALID_ARG, TAG, "参数为空");
+    
+    ws2812b_rmt_backend_t *rmt_backend = calloc(1, sizeof(ws2812b_rmt_backend_t));
+    ESP_RETURN_ON_FALSE(rmt_backend, ESP_ERR_NO_MEM, TAG, "分配RMT后端失败");
+    
+    rmt_backend->on_done = config->on_done;
+    rmt_backend->user_ctx = config->user_ctx;
+    
+    // 创建RMT发送通道
+    rmt_tx_channel_config_t tx_chan_config = {
+        .gpio_num = config->gpio_num,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = WS2812B_RMT_RESOLUTION_HZ,
+        .mem_block_symbols = WS2812B_RMT_MEM_BLOCK_SYMBOLS,
+        .trans_queue_depth = WS2812B_RMT_TRANS_QUEUE_DEPTH,  // 双缓冲只有一帧在发送，不排队
+    };
+    
+    // 流式模式：占用目标允许的最大RMT内存并提高中断优先级，支持DMA的目标直接用DMA
+    if (config->streaming) {
+#if SOC_RMT_SUPPORT_DMA
+        tx_chan_config.flags.with_dma = 1;
+        tx_chan_config.mem_block_symbols = WS2812B_RMT_DMA_MEM_SYMBOLS;
+#else
+        tx_chan_config.mem_block_symbols = WS2812B_RMT_STREAM_MEM_SYMBOLS;
+#endif
+        tx_chan_config.intr_priority = WS2812B_RMT_STREAM_INTR_PRIORITY;
+    }
+    if (config->mem_block_symbols) {
+        tx_chan_config.mem_block_symbols = config->mem_block_symbols;
+    }
+    ESP_GOTO_ON_ERROR(rmt_new_tx_channel(&tx_chan_config, &rmt_backend->tx_chan), err, TAG, "创建RMT通道失败");
+    
+    // 注册发送完成回调（必须在启用通道之前）
+    rmt_tx_event_callbacks_t cbs = {
+        .on_trans_done = ws2812b_rmt_tx_done_isr,
+    };
+    ESP_GOTO_ON_ERROR(rmt_tx_register_event_callbacks(rmt_backend->tx_chan, &cbs, rmt_backend),
+                      err, TAG, "注册发送完成回调失败");
+    
+    // 创建编码器（整个灯带生命周期内复用，刷新时不再分配内存）
+    ESP_GOTO_ON_ERROR(ws2812b_rmt_new_encoder(config->chip, config->color_order, tx_chan_config.mem_block_symbols,
+                                              &rmt_backend->encoder),
+                      err, TAG, "创建编码器失败");
+    
+    // 启用RMT通道
+    ESP_GOTO_ON_ERROR(rmt_enable(rmt_backend->tx_chan), err, TAG, "启用RMT通道失败");
+    
+    rmt_backend->base.transmit = ws2812b_rmt_transmit;
+    rmt_backend->base.wait_done = ws2812b_rmt_wait_done;
+    rmt_backend->base.get_underruns = ws2812b_rmt_get_underruns;
+    rmt_backend->base.del = ws2812b_rmt_del;
+    
+    *ret_backend = &rmt_backend->base;
+    return ESP_OK;
+    
+err:
+    if (rmt_backend->encoder) {
+        rmt_del_encoder(rmt_backend->encoder);
+    }
+    if (rmt_backend->tx_chan) {
+        rmt_del_channel(rmt_backend->tx_chan);
+    }
+    free(rmt_backend);
+    return ret;
+}
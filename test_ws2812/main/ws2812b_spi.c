@@ -0,0 +1,165 @@
+#include "ws2812b_backend.h"
+#include "driver/spi_master.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "WS2812B_SPI";
+
+// SPI后端
+typedef struct {
+    ws2812b_backend_t base;
+    spi_host_device_t host;                 // SPI主机
+    spi_device_handle_t device;             // SPI设备
+    spi_transaction_t trans;                // 常驻事务描述符
+    uint8_t *dma_buffer;                    // 展开后的SPI位流（DMA可访问）
+    size_t dma_size;                        // SPI位流字节数
+    const uint8_t *order;                   // 线上字节顺序映射
+    uint8_t bytes_per_pixel;                // 每像素字节数
+    bool pending;                           // 是否有未取回结果的事务
+    ws2812b_backend_done_cb_t on_done;      // 发送完成通知
+    void *user_ctx;
+} ws2812b_spi_backend_t;
+
+// SPI事务完成回调（中断上下文）
+static void IRAM_ATTR ws2812b_spi_post_cb(spi_transaction_t *trans)
+{
+    ws2812b_spi_backend_t *spi_backend = (ws2812b_spi_backend_t *)trans->user;
+    spi_backend->on_done(spi_backend->user_ctx);
+}
+
+// 发送一帧：展开到DMA缓冲区后提交SPI事务
+// size可以小于整条灯带（只发送前面变化的部分），事务长度按实际展开的位流计算
+static esp_err_t ws2812b_spi_transmit(ws2812b_backend_t *backend, const void *pixels, size_t size,
+                                      const uint8_t *lut, bool nonblocking)
+{
+    ws2812b_spi_backend_t *spi_backend = __containerof(backend, ws2812b_spi_backend_t, base);
+    
+    ESP_RETURN_ON_FALSE(!spi_backend->pending, ESP_ERR_INVALID_STATE, TAG, "上一帧尚未发送完成");
+    
+    ws2812b_spi_encode_frame(pixels, size, spi_backend->order, spi_backend->bytes_per_pixel,
+                             lut, spi_backend->dma_buffer);
+    
+    spi_backend->trans.length = (size * WS2812B_SPI_BYTES_PER_BYTE + WS2812B_SPI_RESET_BYTES) * 8;
+    spi_backend->trans.tx_buffer = spi_backend->dma_buffer;
+    spi_backend->trans.user = spi_backend;
+    
+    esp_err_t ret = spi_device_queue_trans(spi_backend->device, &spi_backend->trans,
+                                           nonblocking ? 0 : portMAX_DELAY);
+    if (ret == ESP_OK) {
+        spi_backend->pending = true;
+    }
+    
+    return ret;
+}
+
+// 等待发送完成
+static esp_err_t ws2812b_spi_wait_done(ws2812b_backend_t *backend, int timeout_ms)
+{
+    ws2812b_spi_backend_t *spi_backend = __containerof(backend, ws2812b_spi_backend_t, base);
+    
+    if (!spi_backend->pending) {
+        return ESP_OK;
+    }
+    
+    spi_transaction_t *trans = NULL;
+    TickType_t ticks = timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    esp_err_t ret = spi_device_get_trans_result(spi_backend->device, &trans, ticks);
+    if (ret == ESP_OK) {
+        spi_backend->pending = false;
+    }
+    
+    return ret;
+}
+
+// SPI通过DMA整帧发送，不存在补充数据欠载
+static uint32_t ws2812b_spi_get_underruns(ws2812b_backend_t *backend)
+{
+    return 0;
+}
+
+// 删除后端
+static esp_err_t ws2812b_spi_del(ws2812b_backend_t *backend)
+{
+    ws2812b_spi_backend_t *spi_backend = __containerof(backend, ws2812b_spi_backend_t, base);
+    
+    ws2812b_spi_wait_done(backend, WS2812B_TIMEOUT_MS);
+    spi_bus_remove_device(spi_backend->device);
+    spi_bus_free(spi_backend->host);
+    heap_caps_free(spi_backend->dma_buffer);
+    free(spi_backend);
+    
+    return ESP_OK;
+}
+
+// 创建SPI后端
+esp_err_t ws2812b_new_spi_backend(const ws2812b_backend_config_t *config, ws2812b_backend_t **ret_backend)
+{
+    esp_err_t ret = ESP_OK;
+    bool bus_initialized = false;
+    
+    ESP_RETURN_ON_FALSE(config && ret_backend && config->on_done, ESP_ERR_INVALID_ARG, TAG, "参数为空");
+    
+    // 3个SPI位表示一个数据位，高电平时间只能是SPI位时间的1倍或2倍
+    const ws2812b_chip_t *chip = config->chip;
+    ESP_RETURN_ON_FALSE(abs((int)chip->t0h_ns - WS2812B_SPI_T0H_NS) <= WS2812B_SPI_TOLERANCE_NS &&
+                        abs((int)chip->t1h_ns - WS2812B_SPI_T1H_NS) <= WS2812B_SPI_TOLERANCE_NS &&
+                        chip->reset_us <= WS2812B_RESET_TIME_US,
+                        ESP_ERR_NOT_SUPPORTED, TAG, "SPI后端不支持%s的时序", chip->name);
+    
+    ws2812b_spi_backend_t *spi_backend = calloc(1, sizeof(ws2812b_spi_backend_t));
+    ESP_RETURN_ON_FALSE(spi_backend, ESP_ERR_NO_MEM, TAG, "分配SPI后端失败");
+    
+    spi_backend->host = config->spi_host;
+    spi_backend->order = ws2812b_order_map[config->color_order];
+    spi_backend->bytes_per_pixel = chip->bytes_per_pixel;
+    spi_backend->on_done = config->on_done;
+    spi_backend->user_ctx = config->user_ctx;
+    
+    // 展开后的位流需要DMA可访问的内存
+    spi_backend->dma_size = ws2812b_spi_frame_size(config->led_count, chip->bytes_per_pixel);
+    spi_backend->dma_buffer = heap_caps_calloc(1, spi_backend->dma_size, MALLOC_CAP_DMA);
+    ESP_GOTO_ON_FALSE(spi_backend->dma_buffer, ESP_ERR_NO_MEM, err, TAG, "分配DMA缓冲区失败");
+    
+    // 只使用MOSI引脚输出数据
+    spi_bus_config_t bus_config = {
+        .mosi_io_num = config->gpio_num,
+        .miso_io_num = -1,
+        .sclk_io_num = -1,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = spi_backend->dma_size,
+    };
+    ESP_GOTO_ON_ERROR(spi_bus_initialize(spi_backend->host, &bus_config, SPI_DMA_CH_AUTO),
+                      err, TAG, "初始化SPI总线失败");
+    bus_initialized = true;
+    
+    spi_device_interface_config_t dev_config = {
+        .clock_speed_hz = WS2812B_SPI_CLOCK_HZ,
+        .mode = 0,
+        .spics_io_num = -1,
+        .queue_size = 1,
+        .post_cb = ws2812b_spi_post_cb,
+    };
+    ESP_GOTO_ON_ERROR(spi_bus_add_device(spi_backend->host, &dev_config, &spi_backend->device),
+                      err, TAG, "添加SPI设备失败");
+    
+    spi_backend->base.transmit = ws2812b_spi_transmit;
+    spi_backend->base.wait_done = ws2812b_spi_wait_done;
+    spi_backend->base.get_underruns = ws2812b_spi_get_underruns;
+    spi_backend->base.del = ws2812b_spi_del;
+    
+    *ret_backend = &spi_backend->base;
+    return ESP_OK;
+    
+err:
+    if (bus_initialized) {
+        spi_bus_free(spi_backend->host);
+    }
+    heap_caps_free(spi_backend->dma_buffer);
+    free(spi_backend);
+    return ret;
+}
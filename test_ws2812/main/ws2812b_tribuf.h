@@ -0,0 +1,58 @@
+#ifndef WS2812B_TRIBUF_H
+#define WS2812B_TRIBUF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 三缓冲无锁交接：一个生产者、一个消费者，各自独占一个槽位，第三个槽位存放最新发布的数据
+// 生产者写完自己的槽位后与“最新”槽位交换，消费者需要时再与“最新”槽位交换，双方都不会等待
+// 生产者比消费者快时，未被取走的数据直接被下一次发布覆盖，消费者总是拿到最新的完整数据
+// 调用者按槽位序号（0-2）管理实际的缓冲区
+
+#define WS2812B_TRIBUF_FRESH    0x4     // “最新”槽位有尚未取走的数据
+
+typedef struct {
+    atomic_uint ready;                  // 低2位为“最新”槽位序号，加上WS2812B_TRIBUF_FRESH标志
+    uint8_t write;                      // 生产者正在写的槽位
+    uint8_t read;                       // 消费者正在读的槽位
+} ws2812b_tribuf_t;
+
+// 静态初始化
+#define WS2812B_TRIBUF_INIT     {.ready = 1, .write = 0, .read = 2}
+
+static inline void ws2812b_tribuf_init(ws2812b_tribuf_t *tb)
+{
+    atomic_store(&tb->ready, 1);
+    tb->write = 0;
+    tb->read = 2;
+}
+
+// 生产者：发布刚写完的槽位，换回一个空闲槽位继续写；返回true表示上一次发布的数据没有被取走就被覆盖了
+static inline bool ws2812b_tribuf_publish(ws2812b_tribuf_t *tb)
+{
+    unsigned prev = atomic_exchange(&tb->ready, tb->write | WS2812B_TRIBUF_FRESH);
+    tb->write = prev & 0x3;
+    return prev & WS2812B_TRIBUF_FRESH;
+}
+
+// 消费者：有新数据时换到最新槽位并返回true，否则保持当前槽位
+static inline bool ws2812b_tribuf_acquire(ws2812b_tribuf_t *tb)
+{
+    if (!(atomic_load(&tb->ready) & WS2812B_TRIBUF_FRESH)) {
+        return false;
+    }
+    unsigned prev = atomic_exchange(&tb->ready, tb->read);
+    tb->read = prev & 0x3;
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS2812B_TRIBUF_H